@@ -0,0 +1,35 @@
+#include <SDL2/SDL.h>
+#include <cstdlib>
+#include <new>
+
+#include "liveMetrics.h"
+
+// replaces the global allocator to count heap allocations per thread for
+// live metrics; only linked into sdl-game with make COUNT_ALLOCATIONS=1
+
+static bool counted = (liveMetrics::allocationsCounted = true);
+
+void *operator new(std::size_t size)
+{
+	liveMetrics::allocations++;
+
+	void *p = malloc(size ? size : 1);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
@@ -0,0 +1,43 @@
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "animations.h"
+
+namespace animations {
+
+static std::vector<animation> all;
+
+int define(const animation &a)
+{
+	animation built = a;
+
+	// pingpong is a loop over the frames there and back, ends not repeated
+	if (a.mode == PINGPONG)
+	{
+		for (int i = (int)a.frames.size() - 2; i > 0; i--)
+			built.frames.push_back(a.frames[i]);
+		built.mode = LOOP;
+	}
+
+	built.frameAt.clear();
+	for (size_t i = 0; i < built.frames.size(); i++)
+		for (Uint32 t = 0; t < built.frames[i].ticks; t++)
+			built.frameAt.push_back(i);
+
+	all.push_back(built);
+	return all.size() - 1;
+}
+
+const SDL_Rect *at(const int &id, const Uint32 &age)
+{
+	if (id < 0)
+		return nullptr;
+
+	const animation &a = all[id];
+	Uint32 length = a.frameAt.size();
+
+	Uint32 t = age < length ? age : a.mode == LOOP ? age % length : length - 1;
+	return &a.frames[a.frameAt[t]].src;
+}
+
+} // end namespace
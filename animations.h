@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// sprite flipbooks
+// ================
+// An archetype's image can be an atlas page of equally sized frames. The
+// frame shown is a pure function of an object's age in ticks, looked up in
+// a per-tick table, so objects keep no animation state beyond their spawn
+// tick and replay identically after a rollback. Only the source rect
+// changes, every frame of a kind draws from the same texture.
+namespace animations {
+
+	enum Modes
+	{
+		LOOP,
+		ONCE, // holds the last frame
+		PINGPONG // forwards then backwards, end frames shown once per cycle
+	};
+
+	struct frame {
+		SDL_Rect src; // in the atlas page
+		Uint32 ticks = 1; // at least one
+	};
+
+	struct animation {
+		std::vector<frame> frames;
+		int mode = LOOP;
+
+		// filled by define
+		std::vector<Uint16> frameAt; // frame index for each tick of a cycle
+	};
+
+	// add animation, returns its id
+	extern int define(const animation &a);
+
+	// source rect for an object age ticks old, nullptr for no animation
+	extern const SDL_Rect *at(const int &id, const Uint32 &age);
+
+} // end namespace
@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <SDL2/SDL.h>
+
+#include "logger.h"
+#include "assetPack.h"
+
+namespace assetPack {
+
+const char MAGIC[8] = {'S', 'D', 'L', 'G', 'P', 'A', 'C', 'K'};
+const Uint32 VERSION = 1;
+
+static const size_t ALIGN = 64; // pixel data start, one cache line
+
+// LZ4 block format limits
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5; // block ends in at least this many literals
+static const size_t MATCH_LIMIT = 12; // no match starts in the last bytes
+static const size_t MAX_OFFSET = 65535;
+static const int HASH_BITS = 14;
+
+static const Uint8 *mapped = nullptr;
+static size_t mappedSize = 0;
+static std::map<std::string, const entry *> index;
+static stats counts;
+
+// LZ4
+// ===
+
+static Uint32 read32(const Uint8 *p)
+{
+	Uint32 v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static Uint32 hash(const Uint32 &v)
+{
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// lengths past the token's 15 continue in bytes of 255
+static void putLength(std::vector<Uint8> &out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		out.push_back(255);
+	out.push_back(length);
+}
+
+static bool getLength(const Uint8 *src, const size_t &size, size_t &i, size_t &length)
+{
+	Uint8 b;
+	do
+	{
+		if (i >= size)
+			return false;
+		b = src[i++];
+		length += b;
+	} while (b == 255);
+
+	return true;
+}
+
+static void putSequence(std::vector<Uint8> &out, const Uint8 *literals, const size_t &literalLength, const size_t &offset, const size_t &matchLength)
+{
+	size_t extra = matchLength - MIN_MATCH;
+	out.push_back((std::min(literalLength, (size_t)15) << 4) | std::min(extra, (size_t)15));
+
+	if (literalLength >= 15)
+		putLength(out, literalLength - 15);
+	out.insert(out.end(), literals, literals + literalLength);
+
+	out.push_back(offset & 0xff);
+	out.push_back(offset >> 8);
+	if (extra >= 15)
+		putLength(out, extra - 15);
+}
+
+std::vector<Uint8> compressBlock(const Uint8 *src, const size_t &size)
+{
+	std::vector<Uint8> out;
+	out.reserve(size / 2 + 16);
+
+	// last position each 4 byte value was seen at, greedy first match
+	std::vector<Uint32> table(1 << HASH_BITS, 0);
+	size_t anchor = 0;
+
+	if (size > MATCH_LIMIT)
+	{
+		size_t i = 1;
+		const size_t limit = size - MATCH_LIMIT;
+		const size_t end = size - LAST_LITERALS;
+
+		while (i < limit)
+		{
+			Uint32 v = read32(src + i);
+			Uint32 h = hash(v);
+			size_t ref = table[h];
+			table[h] = i;
+
+			if (i - ref > MAX_OFFSET || read32(src + ref) != v)
+			{
+				i++;
+				continue;
+			}
+
+			size_t length = MIN_MATCH;
+			while (i + length < end && src[ref + length] == src[i + length])
+				length++;
+
+			// matches often start a little before the hashed position
+			while (i > anchor && ref > 0 && src[i - 1] == src[ref - 1])
+			{
+				i--;
+				ref--;
+				length++;
+			}
+
+			putSequence(out, src + anchor, i - anchor, i - ref, length);
+			i += length;
+			anchor = i;
+
+			if (i - 2 < limit)
+				table[hash(read32(src + i - 2))] = i - 2;
+		}
+	}
+
+	// literals to the end
+	size_t literalLength = size - anchor;
+	out.push_back(std::min(literalLength, (size_t)15) << 4);
+	if (literalLength >= 15)
+		putLength(out, literalLength - 15);
+	out.insert(out.end(), src + anchor, src + size);
+
+	return out;
+}
+
+bool decompressBlock(const Uint8 *src, const size_t &size, Uint8 *dst, const size_t &dstSize)
+{
+	size_t i = 0;
+	size_t o = 0;
+
+	while (i < size)
+	{
+		Uint8 token = src[i++];
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !getLength(src, size, i, literalLength))
+			return false;
+		if (literalLength > size - i || literalLength > dstSize - o)
+			return false;
+
+		memcpy(dst + o, src + i, literalLength);
+		i += literalLength;
+		o += literalLength;
+
+		// the last sequence has no match
+		if (i == size)
+			break;
+
+		if (size - i < 2)
+			return false;
+		size_t offset = src[i] | src[i + 1] << 8;
+		i += 2;
+		if (offset == 0 || offset > o)
+			return false;
+
+		size_t length = token & 15;
+		if (length == 15 && !getLength(src, size, i, length))
+			return false;
+		length += MIN_MATCH;
+		if (length > dstSize - o)
+			return false;
+
+		// a match may overlap its own output, a run of one pixel is offset 4;
+		// copy whole periods, doubling what is available each time
+		Uint8 *to = dst + o;
+		const Uint8 *from = to - offset;
+		for (size_t done = 0; done < length;)
+		{
+			size_t n = std::min(offset + done, length - done);
+			memcpy(to + done, from, n);
+			done += n;
+		}
+		o += length;
+	}
+
+	return o == dstSize;
+}
+
+// archive
+// =======
+
+static bool sourceStat(const std::string &path, Sint64 &size, Sint64 &time)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) < 0)
+		return false;
+
+	size = st.st_size;
+	time = st.st_mtime;
+	return true;
+}
+
+bool write(const std::string &fileName, const std::vector<image> &images, const bool &compress)
+{
+	std::vector<entry> entries(images.size());
+	std::vector<std::vector<Uint8>> stored(images.size());
+
+	// names follow the entries, pixels follow the names
+	size_t offset = sizeof(header) + entries.size() * sizeof(entry);
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const image &img = images[i];
+		entry &e = entries[i];
+		memset(&e, 0, sizeof(e));
+
+		if (!sourceStat(img.path, e.sourceSize, e.sourceTime))
+		{
+			LOG_ERROR("Could not stat \"", img.path, "\"");
+			return false;
+		}
+
+		e.nameOffset = offset;
+		e.nameLength = img.path.size();
+		e.width = img.width;
+		e.height = img.height;
+		offset += img.path.size();
+
+		const Uint8 *pixels = (const Uint8 *)img.pixels.data();
+		size_t raw = img.pixels.size() * 4;
+
+		// only kept if it saves space, photos barely compress
+		e.compression = RAW;
+		if (compress)
+		{
+			stored[i] = compressBlock(pixels, raw);
+			if (stored[i].size() < raw)
+				e.compression = LZ4;
+		}
+		if (e.compression == RAW)
+			stored[i].assign(pixels, pixels + raw);
+
+		e.storedSize = stored[i].size();
+	}
+
+	for (auto &e : entries)
+	{
+		offset = (offset + ALIGN - 1) / ALIGN * ALIGN;
+		e.dataOffset = offset;
+		offset += e.storedSize;
+	}
+
+	// write beside and rename over, a running game keeps its old mapping
+	std::string temp = fileName + ".tmp";
+	FILE *out = fopen(temp.c_str(), "wb");
+	if (out == nullptr)
+	{
+		LOG_ERROR("Could not open \"", temp, "\" for writing");
+		return false;
+	}
+
+	header h;
+	memcpy(h.magic, MAGIC, sizeof(h.magic));
+	h.version = VERSION;
+	h.count = entries.size();
+
+	bool ok = fwrite(&h, sizeof(h), 1, out) == 1;
+	if (!entries.empty())
+		ok = ok && fwrite(entries.data(), sizeof(entry), entries.size(), out) == entries.size();
+	for (auto &img : images)
+		ok = ok && fwrite(img.path.data(), 1, img.path.size(), out) == img.path.size();
+
+	static const Uint8 zeros[ALIGN] = {};
+	for (size_t i = 0; i < entries.size() && ok; i++)
+	{
+		long at = ftell(out);
+		ok = fwrite(zeros, 1, entries[i].dataOffset - at, out) == entries[i].dataOffset - at;
+		ok = ok && fwrite(stored[i].data(), 1, stored[i].size(), out) == stored[i].size();
+	}
+
+	ok = fclose(out) == 0 && ok;
+	if (!ok || rename(temp.c_str(), fileName.c_str()) < 0)
+	{
+		LOG_ERROR("Could not write \"", fileName, "\"");
+		remove(temp.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool open(const std::string &fileName)
+{
+	close();
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) < 0)
+	{
+		if (fd >= 0) ::close(fd);
+		LOG_INFO("No asset pack \"", fileName, "\", loading images");
+		return false;
+	}
+
+	if ((size_t)st.st_size < sizeof(header))
+	{
+		::close(fd);
+		LOG_WARN("Asset pack \"", fileName, "\" is truncated");
+		return false;
+	}
+
+	// private and writable so a backend writing to a surface copies a page
+	// instead of faulting; nothing is written back
+	void *data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		LOG_WARN("Could not map asset pack \"", fileName, "\"");
+		return false;
+	}
+
+	mapped = (const Uint8 *)data;
+	mappedSize = st.st_size;
+
+	const header *h = (const header *)mapped;
+	if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION
+		|| h->count > (mappedSize - sizeof(header)) / sizeof(entry))
+	{
+		LOG_WARN("Asset pack \"", fileName, "\" is not version ", VERSION);
+		close();
+		return false;
+	}
+
+	const entry *entries = (const entry *)(mapped + sizeof(header));
+	for (Uint32 i = 0; i < h->count; i++)
+	{
+		const entry &e = entries[i];
+		Uint64 raw = (Uint64)e.width * e.height * 4;
+
+		bool inside = e.nameOffset <= mappedSize && e.nameLength <= mappedSize - e.nameOffset
+			&& e.dataOffset <= mappedSize && e.storedSize <= mappedSize - e.dataOffset;
+		bool sized = e.compression == LZ4 || (e.compression == RAW && e.storedSize == raw);
+
+		if (!inside || !sized || e.dataOffset % ALIGN != 0)
+		{
+			LOG_WARN("Asset pack \"", fileName, "\" is damaged");
+			close();
+			return false;
+		}
+
+		index[std::string((const char *)mapped + e.nameOffset, e.nameLength)] = &e;
+	}
+
+	madvise(data, mappedSize, MADV_WILLNEED);
+	counts.packed = index.size();
+
+	LOG_INFO("Asset pack \"", fileName, "\": ", index.size(), " images, ", mappedSize / 1024, " KB");
+	return true;
+}
+
+void close()
+{
+	if (mapped)
+		munmap((void *)mapped, mappedSize);
+
+	mapped = nullptr;
+	mappedSize = 0;
+	index.clear();
+	counts.packed = 0;
+}
+
+SDL_Surface *load(const std::string &path)
+{
+	auto found = index.find(path);
+	if (found == index.end())
+		return nullptr;
+
+	const entry &e = *found->second;
+
+	// an edited image wins over its packed copy; a missing one is served from the pack
+	Sint64 size, time;
+	if (sourceStat(path, size, time) && (size != e.sourceSize || time != e.sourceTime))
+	{
+		counts.stale++;
+		LOG_DEBUG("Asset pack copy is stale: ", path);
+		return nullptr;
+	}
+
+	Uint8 *data = (Uint8 *)mapped + e.dataOffset;
+	SDL_Surface *surface;
+
+	if (e.compression == RAW)
+		surface = SDL_CreateRGBSurfaceWithFormatFrom(data, e.width, e.height, 32, e.width * 4, SDL_PIXELFORMAT_ARGB8888);
+	else
+	{
+		surface = SDL_CreateRGBSurfaceWithFormat(0, e.width, e.height, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (surface && !decompressBlock(data, e.storedSize, (Uint8 *)surface->pixels, (size_t)e.width * e.height * 4))
+		{
+			LOG_WARN("Asset pack copy is corrupt: ", path);
+			SDL_FreeSurface(surface);
+			return nullptr;
+		}
+	}
+
+	if (surface)
+		counts.loads++;
+	return surface;
+}
+
+stats counters()
+{
+	return counts;
+}
+
+} // end namespace
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// packed asset archive
+// ====================
+// One file of images decoded ahead of time by tools/assetPack.cpp, so
+// startup maps a file instead of decoding PNGs. Pixels are stored as
+// ARGB8888, the format the backends upload, optionally LZ4 compressed.
+//
+//   header   magic, version, entry count
+//   entries  one per image: name, size, pixel data offset, source PNG
+//            size and modification time
+//   names    packed strings
+//   pixels   each image 64 byte aligned
+//
+// An entry is only used while its PNG still has the size and mtime it was
+// packed with, otherwise the PNG is loaded as before.
+namespace assetPack {
+
+	enum Compressions
+	{
+		RAW,
+		LZ4 // LZ4 block format
+	};
+
+	struct header {
+		char magic[8];
+		Uint32 version;
+		Uint32 count;
+	};
+
+	struct entry {
+		Uint32 nameOffset; // from start of file
+		Uint32 nameLength;
+		Uint32 width;
+		Uint32 height;
+		Uint32 compression;
+		Uint32 storedSize; // bytes at dataOffset
+		Uint64 dataOffset;
+		Sint64 sourceSize; // PNG it was packed from
+		Sint64 sourceTime;
+	};
+
+	extern const char MAGIC[8];
+	extern const Uint32 VERSION;
+
+	// image to pack, pixels are ARGB8888 rows with no padding
+	struct image {
+		std::string path;
+		int width = 0;
+		int height = 0;
+		std::vector<Uint32> pixels;
+	};
+
+	// write images to fileName, compressing where it saves space; false on error
+	extern bool write(const std::string &fileName, const std::vector<image> &images, const bool &compress);
+
+	// map archive, false if it is missing or unreadable
+	extern bool open(const std::string &fileName);
+
+	// unmap, surfaces from load() must be freed first
+	extern void close();
+
+	// surface for path if packed and unchanged since, nullptr otherwise;
+	// uncompressed surfaces point into the mapping
+	extern SDL_Surface *load(const std::string &path);
+
+	// LZ4 block codec, for the packer and tests
+	extern std::vector<Uint8> compressBlock(const Uint8 *src, const size_t &size);
+	extern bool decompressBlock(const Uint8 *src, const size_t &size, Uint8 *dst, const size_t &dstSize);
+
+	struct stats {
+		int packed = 0; // entries in the archive
+		int loads = 0; // images served from it
+		int stale = 0; // PNG changed since packing
+	};
+
+	extern stats counters();
+
+} // end namespace
@@ -1,20 +1,45 @@
 #include <map>
 #include <string>
+#include <vector>
 
 #include "baseObjects.h"
-#include "movement.h"
-#include "gameObj.h"
+#include "textureCache.h"
 
-// base objects to copy
+archetype::archetype(const std::string &n, const std::string &image, const double &vel, const int &w, const int &h, const int &bull, const int &dur)
+{
+	name = n;
+	texture = textureCache::entry(image);
+	velocity = vel;
+	width = w;
+	height = h;
+	bullet = bull;
+	duration = dur;
+}
 
-std::map<std::string, gameObj> baseBullets;
+namespace prototypes {
 
-std::map<std::string, gameObj> baseEnemies;
-/*
-std::map<std::string, gameObj> baseEnemies = {
+std::vector<archetype> all;
+
+static std::map<std::string, int> ids; // name to index in all
+
+int define(const archetype &a)
+{
+	auto found = ids.find(a.name);
+	if (found != ids.end())
 	{
-		"bat",
-		gameObj("enemy-bat", 6, 50, 46, 0, 0, "orange", 200)
+		all[found->second] = a;
+		return found->second;
 	}
-};
-*/
+
+	all.push_back(a);
+	ids[a.name] = all.size() - 1;
+	return all.size() - 1;
+}
+
+int find(const std::string &name)
+{
+	auto found = ids.find(name);
+	return found != ids.end() ? found->second : -1;
+}
+
+} // end namespace
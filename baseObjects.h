@@ -1,11 +1,49 @@
+#pragma once
+
 #include <map>
 #include <string>
+#include <vector>
+
+struct cachedTexture;
+
+// what an object is, shared by every object of that kind
+// ======================================================
+// Loaded from config, then read only during play so simulation threads
+// share it. Objects keep their archetype id and only mutable state.
+struct archetype {
+	std::string name; // label in config
+	cachedTexture *texture = nullptr; // resolved once, loaded when first drawn
+	double velocity = 1;
+	int width = 1;
+	int height = 1;
+	int bullet = -1; // archetype id fired, -1 for none
+	int duration = 0; // ms between shots
+	int emitter = -1; // particle burst on death, -1 for none
+	int animation = -1; // flipbook over frames of the image, -1 to draw all of it
+
+	archetype() {}
+
+	// takes name, image path, velocity, width, height, bullet id, ms between shots
+	archetype(const std::string &n, const std::string &image, const double &vel, const int &w, const int &h, const int &bull = -1, const int &dur = 0);
+};
+
+// prototype registry
+// ==================
+// Ids are dense indices assigned in load order, so spawning by id is an
+// array index. Names are only looked up while loading.
+namespace prototypes {
+
+	extern std::vector<archetype> all;
+
+	// add archetype, or replace the one with the same name; returns its id
+	extern int define(const archetype &a);
 
-#include "movement.h"
-#include "gameObj.h"
+	// id of named archetype, -1 if none
+	extern int find(const std::string &name);
 
-// base objects to copy
-class gameObj;
+	inline const archetype &get(const int &id)
+	{
+		return all[id];
+	}
 
-extern std::map<std::string, gameObj> baseBullets;
-extern std::map<std::string, gameObj> baseEnemies;
+} // end namespace
@@ -0,0 +1,300 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "gameObj.h"
+#include "bulletContainers.h"
+#include "telemetry.h"
+#include "particles.h"
+#include "gameState.h"
+#include "animations.h"
+#include "bosses.h"
+
+thread_local std::vector<bossState> currentBosses;
+
+namespace bosses {
+
+const int MAX_PARTS = 256;
+const int MAX_PER_WAVE = 256;
+
+std::vector<bossBlueprint> blueprints;
+
+static std::map<std::string, int> ids; // name to index in blueprints
+
+static bool byId(const gameObj &enemy, const Uint32 &id)
+{
+	return enemy.id < id;
+}
+
+static bool bySlot(const bossState &s, const int &slot)
+{
+	return s.slot < slot;
+}
+
+static bool isEmpty(const SDL_Rect &r)
+{
+	return r.w <= 0 || r.h <= 0;
+}
+
+// grow a to cover b
+static void join(SDL_Rect &a, const SDL_Rect &b)
+{
+	if (isEmpty(a))
+	{
+		a = b;
+		return;
+	}
+
+	int x1 = std::max(a.x + a.w, b.x + b.w);
+	int y1 = std::max(a.y + a.h, b.y + b.h);
+	a.x = std::min(a.x, b.x);
+	a.y = std::min(a.y, b.y);
+	a.w = x1 - a.x;
+	a.h = y1 - a.y;
+}
+
+int define(const bossBlueprint &b)
+{
+	int n = b.parts.size();
+
+	// children of each part in config order, the root has no parent
+	std::vector<std::vector<int>> children(n);
+	int root = 0;
+	for (int i = 0; i < n; i++)
+	{
+		if (b.parts[i].parent < 0)
+			root = i;
+		else
+			children[b.parts[i].parent].push_back(i);
+	}
+
+	// depth first so subtrees are contiguous
+	bossBlueprint sorted;
+	sorted.name = b.name;
+
+	std::vector<int> newIndex(n);
+	std::vector<int> stack(1, root);
+	while (!stack.empty())
+	{
+		int i = stack.back();
+		stack.pop_back();
+
+		newIndex[i] = sorted.parts.size();
+		sorted.parts.push_back(b.parts[i]);
+		sorted.parts.back().subtree = 1;
+
+		for (auto c = children[i].rbegin(); c != children[i].rend(); c++)
+			stack.push_back(*c);
+	}
+
+	for (auto &part : sorted.parts)
+		if (part.parent >= 0)
+			part.parent = newIndex[part.parent];
+
+	// children come after their parent, so sizes add up walking backwards
+	for (int i = n - 1; i > 0; i--)
+		sorted.parts[sorted.parts[i].parent].subtree += sorted.parts[i].subtree;
+
+	auto found = ids.find(b.name);
+	if (found != ids.end())
+	{
+		blueprints[found->second] = sorted;
+		return found->second;
+	}
+
+	blueprints.push_back(sorted);
+	ids[b.name] = blueprints.size() - 1;
+	return blueprints.size() - 1;
+}
+
+int find(const std::string &name)
+{
+	auto found = ids.find(name);
+	return found != ids.end() ? found->second : -1;
+}
+
+// transforms, then bounds from the leaves up
+static void place(bossState &s, const SDL_Rect &rootRect)
+{
+	const std::vector<bossPart> &parts = blueprints[s.blueprint].parts;
+	int n = parts.size();
+
+	s.world[0] = rootRect;
+	for (int i = 1; i < n; i++)
+	{
+		const SDL_Rect &parent = s.world[parts[i].parent];
+		const archetype &a = prototypes::get(parts[i].type);
+		s.world[i] = global::makeRect(parent.x + parts[i].x, parent.y + parts[i].y, a.width, a.height);
+	}
+
+	for (int i = 0; i < n; i++)
+		s.bounds[i] = s.alive[i] ? s.world[i] : global::makeRect(0, 0, 0, 0);
+
+	for (int i = n - 1; i > 0; i--)
+		if (!isEmpty(s.bounds[i]))
+			join(s.bounds[parts[i].parent], s.bounds[i]);
+}
+
+void spawn(const int &wave, const std::vector<gameObj> &enemies)
+{
+	currentBosses.clear();
+
+	for (auto &enemy : enemies)
+	{
+		if (enemy.boss < 0) continue;
+
+		int n = blueprints[enemy.boss].parts.size();
+
+		bossState s;
+		s.id = enemy.id;
+		s.blueprint = enemy.boss;
+		s.wave = wave;
+		s.slot = currentBosses.size();
+		s.world.resize(n);
+		s.bounds.resize(n);
+		s.alive.assign(n, 1);
+		s.canFire.assign(n, 1);
+
+		place(s, enemy.rect);
+		currentBosses.push_back(s);
+	}
+}
+
+// destroy parts first to last, with their burst
+static void destroy(bossState &s, const int &first, const int &last)
+{
+	const std::vector<bossPart> &parts = blueprints[s.blueprint].parts;
+
+	for (int i = first; i < last; i++)
+	{
+		if (!s.alive[i]) continue;
+
+		s.alive[i] = 0;
+		const SDL_Rect &r = s.world[i];
+		particles::emit(prototypes::get(parts[i].type).emitter, r.x + r.w / 2, r.y + r.h / 2);
+	}
+}
+
+// player bullets against the boss hierarchy, true once the root is destroyed
+static bool hit(bossState &s, std::vector<gameObj> &bullets)
+{
+	const std::vector<bossPart> &parts = blueprints[s.blueprint].parts;
+	int n = parts.size();
+
+	for (size_t j = 0; j < bullets.size();)
+	{
+		const SDL_Rect &b = bullets[j].rect;
+
+		// first part hit in preorder, unless a shield is in the way
+		int struck = -1;
+		bool blocked = false;
+
+		for (int i = 0; i < n && !blocked;)
+		{
+			global::collisionTests++;
+			if (!SDL_HasIntersection(&b, &s.bounds[i]))
+			{
+				i += parts[i].subtree;
+				continue;
+			}
+
+			if (s.alive[i] && SDL_HasIntersection(&b, &s.world[i]))
+			{
+				if (parts[i].shield)
+					blocked = true;
+				else if (struck < 0)
+					struck = i;
+			}
+
+			i++;
+		}
+
+		if (!blocked && struck < 0)
+		{
+			j++;
+			continue;
+		}
+
+		bullets.erase(bullets.begin() + j);
+		if (blocked)
+			continue;
+
+		// only the root going down kills the boss
+		const SDL_Rect &r = s.world[struck];
+		telemetry::record(struck == 0 ? telemetry::EVENT_HIT : telemetry::EVENT_PART_DESTROYED, r.x, r.y);
+
+		destroy(s, struck, struck + parts[struck].subtree);
+		if (struck == 0)
+			return true;
+
+		// destroyed subtree no longer bounds anything
+		place(s, s.world[0]);
+	}
+
+	return false;
+}
+
+void step(std::vector<gameObj> &enemies, std::vector<gameObj> &bullets)
+{
+	for (size_t b = 0; b < currentBosses.size();)
+	{
+		bossState &s = currentBosses[b];
+		const std::vector<bossPart> &parts = blueprints[s.blueprint].parts;
+
+		// root flew offscreen
+		auto root = std::lower_bound(enemies.begin(), enemies.end(), s.id, byId);
+		if (root == enemies.end() || root->id != s.id)
+		{
+			currentBosses.erase(currentBosses.begin() + b);
+			continue;
+		}
+
+		place(s, root->rect);
+
+		// root is drawn and scripted as an enemy, the other parts follow it
+		for (size_t i = 1; i < parts.size(); i++)
+		{
+			if (!s.alive[i]) continue;
+
+			const archetype &a = prototypes::get(parts[i].type);
+			const SDL_Rect &r = s.world[i];
+			global::render(a.texture, &r, layer::ENEMY, animations::at(a.animation, global::ticks - root->spawned));
+
+			if (a.bullet >= 0 && s.canFire[i])
+			{
+				addEnemyBullet(gameObj(a.bullet, r.x + r.w / 2 - 8, r.y));
+				telemetry::record(telemetry::EVENT_FIRE, r.x, r.y, 1);
+
+				s.canFire[i] = 0;
+				gameState::timers.add(global::ticks + global::msToTicks(a.duration), gameState::TIMER_PART_FIRE, partTarget(s.wave, s.slot, i));
+			}
+		}
+
+		if (hit(s, bullets))
+		{
+			enemies.erase(root);
+			currentBosses.erase(currentBosses.begin() + b);
+			global::kills++;
+			continue;
+		}
+
+		b++;
+	}
+}
+
+void partCanFire(const Uint32 &target)
+{
+	int wave = target >> 16;
+	int slot = (target >> 8) & 0xFF;
+	int part = target & 0xFF;
+
+	// bosses stay sorted by slot, a missing one was destroyed
+	auto s = std::lower_bound(currentBosses.begin(), currentBosses.end(), slot, bySlot);
+	if (s != currentBosses.end() && s->slot == slot && s->wave == wave)
+		s->canFire[part] = 1;
+}
+
+} // end namespace
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "gameObj.h"
+
+// part of a boss, from config/bosses.conf
+struct bossPart {
+	std::string name;
+	int type = -1; // archetype: texture, size, bullet and fire rate
+	int parent = -1; // index in parts, -1 for the root
+	int x = 0; // offset from parent's top left
+	int y = 0;
+	bool shield = false; // absorbs bullets, can't be destroyed
+	int subtree = 1; // parts in this part's subtree, itself included
+};
+
+// parts in preorder: parents come before children and every subtree is a
+// contiguous run, so transforms and bounds are single linear passes
+struct bossBlueprint {
+	std::string name;
+	std::vector<bossPart> parts;
+};
+
+// a boss in play, its root part is an enemy in currentEnemies
+struct bossState {
+	Uint32 id = 0; // root enemy id
+	int blueprint = -1;
+	int wave = 0; // wave and slot name its parts to timers
+	int slot = 0;
+
+	std::vector<SDL_Rect> world; // part rects on screen
+	std::vector<SDL_Rect> bounds; // part joined with its live subtree, empty once destroyed
+	std::vector<Uint8> alive;
+	std::vector<Uint8> canFire;
+};
+
+// bosses of the wave in play, by slot
+extern thread_local std::vector<bossState> currentBosses;
+
+// multi-part bosses
+// =================
+// Parts follow their parent with a fixed offset and fire on their own
+// cooldowns. Player bullets are tested against each boss's bounding volume
+// hierarchy, built from the part tree: a bullet that misses a part's
+// bounds skips its whole subtree, so a boss that isn't being hit costs one
+// rect test per bullet. Destroying a part takes its subtree with it,
+// destroying the root destroys the boss.
+namespace bosses {
+
+	// parts per boss and bosses per wave, so both fit in a timer target
+	extern const int MAX_PARTS;
+	extern const int MAX_PER_WAVE;
+
+	// loaded from config, read only during play
+	extern std::vector<bossBlueprint> blueprints;
+
+	// add blueprint with parts in any parent-first order, returns its id
+	extern int define(const bossBlueprint &b);
+
+	// id of named blueprint, -1 if none
+	extern int find(const std::string &name);
+
+	// track the bosses among a wave's enemies as it enters play
+	extern void spawn(const int &wave, const std::vector<gameObj> &enemies);
+
+	// after enemies moved: place, draw and fire parts, hit them with bullets
+	extern void step(std::vector<gameObj> &enemies, std::vector<gameObj> &bullets);
+
+	// part fire timer target
+	inline Uint32 partTarget(const int &wave, const int &slot, const int &part) { return (Uint32)wave << 16 | slot << 8 | part; }
+
+	// part fire timer came due
+	extern void partCanFire(const Uint32 &target);
+
+} // end namespace
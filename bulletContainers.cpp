@@ -3,7 +3,15 @@
 #include "gameObj.h"
 
 // player bullet container
-std::vector<gameObj> currentPlayerBullets;
+thread_local std::vector<gameObj> currentPlayerBullets;
 
 // enemy bullet container
-std::vector<gameObj> currentEnemyBullets;
+thread_local std::vector<gameObj> currentEnemyBullets;
+
+thread_local Uint32 nextEnemyBulletId = 1;
+
+void addEnemyBullet(const gameObj &bullet)
+{
+	currentEnemyBullets.push_back(bullet);
+	currentEnemyBullets.back().id = nextEnemyBulletId++;
+}
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <SDL2/SDL.h>
 #include <vector>
 
 class gameObj;
 
 // player bullet container
-extern std::vector<gameObj> currentPlayerBullets;
+extern thread_local std::vector<gameObj> currentPlayerBullets;
 
-// enemy bullet container
-extern std::vector<gameObj> currentEnemyBullets;
+// enemy bullet container, sorted by id
+extern thread_local std::vector<gameObj> currentEnemyBullets;
+
+// id for the next enemy bullet, ids only ever rise
+extern thread_local Uint32 nextEnemyBulletId;
+
+// append an enemy bullet, giving it the next id
+void addEnemyBullet(const gameObj &bullet);
@@ -1,102 +1,276 @@
 #include <string>
 #include <map>
+#include <vector>
 #include <fstream>
-#include <sstream>
 #include "global.h"
 #include "gameObj.h"
 #include "movement.h"
+#include "logger.h"
+#include "configParser.h"
 #include "configFromFile.h"
+#include "particles.h"
+#include "textureCache.h"
+#include "bosses.h"
+#include "animations.h"
+#include "powerScheduler.h"
+
+// textures load when first needed, catch missing files while the line is known
+static void checkImage(configParser &parser, const token &path)
+{
+	std::ifstream file(path.str());
+	if (!file.good())
+		parser.error(path, "can't open image \"" + path.str() + "\"");
+}
+
+// width and height from a PNG header, false if it isn't a PNG
+static bool pngSize(const std::string &path, int &width, int &height)
+{
+	unsigned char header[24];
+	std::ifstream file(path, std::ios::binary);
+	if (!file.read((char *)header, sizeof(header)))
+		return false;
+
+	static const unsigned char SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	for (int i = 0; i < 8; i++)
+		if (header[i] != SIGNATURE[i])
+			return false;
+
+	// IHDR is always the first chunk, big endian width then height
+	width = header[16] << 24 | header[17] << 16 | header[18] << 8 | header[19];
+	height = header[20] << 24 | header[21] << 16 | header[22] << 8 | header[23];
+	return true;
+}
 
-void bulletsFromFile(std::string fileName, std::map<std::string, gameObj> &objMap)
+// "animation label frame-width frame-height mode ms frame[:ms]..."
+// frames are cells of the archetype's image, counted left to right, top to bottom
+static void animationFromLine(configParser &parser, const std::vector<token> &args)
 {
-	std::ifstream infile(fileName);
-	if(!infile)
+	parser.expectArgs(args, 7, "animation label frame-width frame-height loop|once|pingpong ms frame[:ms]...");
+
+	int type = prototypes::find(args[1].str());
+	if (type < 0)
+		parser.error(args[1], "unknown label \"" + args[1].str() + "\", define it above");
+
+	int frameW = parser.toInt(args[2]);
+	int frameH = parser.toInt(args[3]);
+	if (frameW <= 0 || frameH <= 0)
+		parser.error(args[2], "frame size must be positive");
+
+	const std::string &image = prototypes::all[type].texture->path;
+	int imageW, imageH;
+	if (!pngSize(image, imageW, imageH))
+		parser.error(args[1], "can't read size of \"" + image + "\"");
+
+	int columns = imageW / frameW;
+	int cells = columns * (imageH / frameH);
+	if (cells == 0)
+		parser.error(args[2], "frame is larger than \"" + image + "\"");
+
+	animations::animation a;
+	if (args[4] == "loop")
+		a.mode = animations::LOOP;
+	else if (args[4] == "once")
+		a.mode = animations::ONCE;
+	else if (args[4] == "pingpong")
+		a.mode = animations::PINGPONG;
+	else
+		parser.error(args[4], "unknown mode \"" + args[4].str() + "\", use loop, once or pingpong");
+
+	int ms = parser.toInt(args[5]);
+
+	for (size_t i = 6; i < args.size(); i++)
 	{
-		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not open \""+std::string(fileName)+"\".").c_str(), NULL);
-		exit(EXIT_FAILURE);
-	}
+		// cell, or cell:ms to hold this frame longer or shorter
+		token cell = args[i];
+		token duration = args[5];
+		int frameMs = ms;
+
+		for (int c = 0; c < cell.length; c++)
+		{
+			if (cell.data[c] == ':')
+			{
+				duration = cell;
+				duration.data += c + 1;
+				duration.length -= c + 1;
+				duration.column += c + 1;
+				cell.length = c;
+				frameMs = parser.toInt(duration);
+				break;
+			}
+		}
+
+		int index = parser.toInt(cell);
+		if (index < 0 || index >= cells)
+			parser.error(cell, "frame " + std::to_string(index) + " is outside \"" + image + "\", which has " + std::to_string(cells) + " frames");
 
+		if (frameMs <= 0)
+			parser.error(duration, "frame time must be positive");
 
-	std::string line;
-	std::string tok;
+		animations::frame f;
+		f.src = global::makeRect(index % columns * frameW, index / columns * frameH, frameW, frameH);
+		f.ticks = global::msToTicks(frameMs);
+		a.frames.push_back(f);
+	}
+
+	prototypes::all[type].animation = animations::define(a);
+}
 
-	std::vector<std::string> args;
+void bulletsFromFile(std::string fileName)
+{
+	configParser parser(fileName);
+	std::vector<token> args;
 
-	while(std::getline(infile, line)) // read file lines
+	while (parser.nextLine(args))
 	{
-		// handle line
-		if(line[0] != '#') // check for line comment
+		// flipbook for a bullet above
+		if (args[0] == "animation")
 		{
-			std::stringstream ss(line); // stringstream from line
+			animationFromLine(parser, args);
+			continue;
+		}
 
-			// tokenize lines
-			while(std::getline(ss, tok, ' ')) // space delimiter
-				args.push_back(tok);
+		parser.expectArgs(args, 5, "label image.png velocity width height");
 
-			global::allTextures[args[1]] = global::loadTexture(args[1].c_str());
-			objMap[args[0]] = gameObj(args[1], std::stoi(args[2]), std::stoi(args[3]), std::stoi(args[4]));
-		}
+		std::string texture = args[1].str();
+		checkImage(parser, args[1]);
 
-		line = "";
-		tok = "";
-		args.clear();
+		prototypes::define(archetype(args[0].str(), texture, parser.toInt(args[2]), parser.toInt(args[3]), parser.toInt(args[4])));
 	}
-
-	infile.close();
 }
 
-void enemiesFromFile(std::string fileName, std::map<std::string, gameObj> &objMap)
+void enemiesFromFile(std::string fileName)
 {
-	std::ifstream infile(fileName);
-	if(!infile)
+	configParser parser(fileName);
+	std::vector<token> args;
+
+	while (parser.nextLine(args))
 	{
-		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not open \""+std::string(fileName)+"\".").c_str(), NULL);
-		exit(EXIT_FAILURE);
+		// flipbook for an enemy above
+		if (args[0] == "animation")
+		{
+			animationFromLine(parser, args);
+			continue;
+		}
+
+		// death effect for an enemy above, or built-in "player"/"cancel"
+		if (args[0] == "emitter")
+		{
+			parser.expectArgs(args, 9, "emitter label red green blue count speed life size");
+
+			particles::emitter e;
+			e.color.r = parser.toInt(args[2]);
+			e.color.g = parser.toInt(args[3]);
+			e.color.b = parser.toInt(args[4]);
+			e.count = parser.toInt(args[5]);
+			e.speed = parser.toInt(args[6]);
+			e.life = parser.toInt(args[7]);
+			e.size = parser.toInt(args[8]);
+
+			if (e.count <= 0 || e.life <= 0 || e.size <= 0)
+				parser.error(args[5], "count, life and size must be positive");
+
+			std::string label = args[1].str();
+			int enemy = prototypes::find(label);
+
+			if (enemy >= 0)
+				prototypes::all[enemy].emitter = particles::define(label, e);
+			else if (particles::find(label) >= 0)
+				particles::define(label, e);
+			else
+				parser.error(args[1], "unknown enemy \"" + label + "\"");
+
+			continue;
+		}
+
+		parser.expectArgs(args, 7, "label image.png velocity width height bullet-label bullet-duration");
+
+		// "-" for a part that never fires
+		int bullet = args[5] == "-" ? -1 : prototypes::find(args[5].str());
+		if (bullet < 0 && args[5] != "-")
+			parser.error(args[5], "unknown bullet \"" + args[5].str() + "\"");
+
+		std::string texture = args[1].str();
+		checkImage(parser, args[1]);
+
+		prototypes::define(archetype(args[0].str(), texture, parser.toInt(args[2]), parser.toInt(args[3]), parser.toInt(args[4]), bullet, parser.toInt(args[6])));
 	}
+}
 
-	std::string line;
-	std::string tok;
+void bossesFromFile(std::string fileName)
+{
+	configParser parser(fileName);
+	std::vector<token> args;
 
-	std::vector<std::string> args;
+	// blueprints in order of first line
+	std::vector<bossBlueprint> blueprints;
+	std::map<std::string, int> index;
 
-	while(std::getline(infile, line))
+	while (parser.nextLine(args))
 	{
-		if(line[0] != '#') // check for line comment
+		parser.expectArgs(args, 6, "boss-label part-label parent-label enemy-label x-offset y-offset [shield]");
+
+		std::string name = args[0].str();
+		if (index.count(name) == 0)
 		{
-			std::stringstream ss(line); // stringstream from line
+			index[name] = blueprints.size();
+			blueprints.push_back(bossBlueprint());
+			blueprints.back().name = name;
+		}
+		bossBlueprint &boss = blueprints[index[name]];
 
-			while(std::getline(ss, tok, ' ')) // space delimiter
-				args.push_back(tok);
+		bossPart part;
+		part.name = args[1].str();
 
-			global::allTextures[args[1]] = global::loadTexture(args[1].c_str());
+		for (auto &other : boss.parts)
+			if (other.name == part.name)
+				parser.error(args[1], "part \"" + part.name + "\" is already in " + name);
 
-			objMap[args[0]] = gameObj(args[1], std::stoi(args[2]), std::stoi(args[3]), std::stoi(args[4]), 0, 0, args[5], std::stoi(args[6]));
+		// parents are listed before their children, "-" for the root
+		if (args[2] == "-")
+		{
+			if (!boss.parts.empty())
+				parser.error(args[2], "root must be the first part of " + name);
+		}
+		else
+		{
+			for (size_t i = 0; i < boss.parts.size(); i++)
+				if (args[2].str() == boss.parts[i].name)
+					part.parent = i;
 
+			if (part.parent < 0)
+				parser.error(args[2], "unknown parent \"" + args[2].str() + "\", list parents first");
+		}
 
+		part.type = prototypes::find(args[3].str());
+		if (part.type < 0)
+			parser.error(args[3], "unknown enemy \"" + args[3].str() + "\"");
+
+		part.x = parser.toInt(args[4]);
+		part.y = parser.toInt(args[5]);
+
+		if (args.size() > 6)
+		{
+			if (args[6] != "shield")
+				parser.error(args[6], "unknown part flag \"" + args[6].str() + "\"");
+			if (part.parent < 0)
+				parser.error(args[6], "root can't be a shield");
+			part.shield = true;
 		}
 
-		line = "";
-		tok = "";
-		args.clear();
-	}
+		if ((int)boss.parts.size() >= bosses::MAX_PARTS)
+			parser.error(args[1], name + " has more than " + std::to_string(bosses::MAX_PARTS) + " parts");
 
-	infile.close();
+		boss.parts.push_back(part);
+	}
 
+	for (auto &boss : blueprints)
+		bosses::define(boss);
 }
 
 void wavesFromFile(std::string fileName, std::vector<std::vector<gameObj>> &objVec)
 {
-	std::ifstream infile(fileName);
-	if(!infile)
-	{
-		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not open \""+std::string(fileName)+"\".").c_str(), NULL);
-		exit(EXIT_FAILURE);
-	}
-
-	std::string line;
-	std::string tok;
-
-	std::vector<std::string> args;
+	configParser parser(fileName);
+	std::vector<token> args;
 
 	gameObj enemy;
 	std::vector<bool (*)(gameObj*)> animSet;
@@ -104,66 +278,114 @@ void wavesFromFile(std::string fileName, std::vector<std::vector<gameObj>> &objV
 
 	bool onEnemy = true;
 
-	// read file lines
-	while(std::getline(infile, line))
+	while (parser.nextLine(args))
 	{
-		// handle lines
-		if(line.length() > 0 && line[0] != '#') // check for line comment
+		if (args[0] == "ENDE") // end adding anims to enemy, store enemy in wave
 		{
+			if (onEnemy)
+				parser.error(args[0], "ENDE without enemy");
 
-			// blank line: end adding anims to enemy, store enemy in wave
-			if(line == "ENDE")
-			{
-				wave.push_back(enemy);
-				onEnemy = true;
-			}
-			else if(line == "ENDW") // end wave, store wave
-			{
-				objVec.push_back(wave);
-				wave.clear();
-			}
-			else
-			{
-				std::stringstream ss(line); // stringstream from line
+			wave.push_back(enemy);
+			onEnemy = true;
+		}
+		else if (args[0] == "ENDW") // end wave, store wave
+		{
+			int count = 0;
+			for (auto &e : wave)
+				if (e.boss >= 0)
+					count++;
 
-				// tokenize lines
-				while(std::getline(ss, tok, ' ')) // space delimiter
-					args.push_back(tok);
+			if (count > bosses::MAX_PER_WAVE)
+				parser.error(args[0], "wave has more than " + std::to_string(bosses::MAX_PER_WAVE) + " bosses");
 
-				// enemy data line
-				if(onEnemy)
-				{
-					enemy = gameObj(baseEnemies[args[0]], std::stoi(args[1]), std::stoi(args[2]));
-					onEnemy = false;
-				}
-				else // movement data line
+			objVec.push_back(wave);
+			wave.clear();
+		}
+		else if (onEnemy) // enemy data line
+		{
+			parser.expectArgs(args, 3, "enemy-label x-pos y-pos");
+
+			// a boss moves as its root part
+			int boss = bosses::find(args[0].str());
+			int base = boss >= 0 ? bosses::blueprints[boss].parts[0].type : prototypes::find(args[0].str());
+			if (base < 0)
+				parser.error(args[0], "unknown enemy \"" + args[0].str() + "\"");
+
+			enemy = gameObj(base, parser.toInt(args[1]), parser.toInt(args[2]));
+			enemy.boss = boss;
+			onEnemy = false;
+		}
+		else // movement data line
+		{
+			parser.expectArgs(args, 2, "distance movement1 movementN...");
+
+			for (size_t i = 1; i < args.size(); i++)
+			{
+				const token &t = args[i];
+
+				if (t == "up")
+					animSet.push_back(movement::up);
+				else if (t == "down")
+					animSet.push_back(movement::down);
+				else if (t == "left")
+					animSet.push_back(movement::left);
+				else if (t == "right")
+					animSet.push_back(movement::right);
+				else if (t == "fire")
 				{
-					for(auto token : args)
-					{
-						if(token == "up")
-							animSet.push_back(movement::up);
-						else if(token == "down")
-							animSet.push_back(movement::down);
-						else if(token == "left")
-							animSet.push_back(movement::left);
-						else if(token == "right")
-							animSet.push_back(movement::right);
-						else if(token == "fire")
-							animSet.push_back(movement::fire);
-					}
-
-					enemy.addAnimationSet(animSet, std::stoi(args[0]));
-					animSet.clear();
+					if (enemy.proto().bullet < 0)
+						parser.error(t, "enemy has no bullet to fire");
+					animSet.push_back(movement::fire);
 				}
-				
-
-				tok = "";
-				args.clear();
+				else
+					parser.error(t, "unknown movement \"" + t.str() + "\"");
 			}
-		} // end if line commented check
-			
+
+			enemy.addAnimationSet(animSet, parser.toInt(args[0]));
+			animSet.clear();
+		}
 	}
 
-	infile.close();
+	if (!onEnemy || !wave.empty())
+		LOG_WARN(fileName, ": ignoring enemies after last ENDE/ENDW");
+}
 
+void videoFromFile(std::string fileName, resolutionScaler::settings &settings)
+{
+	configParser parser(fileName);
+	std::vector<token> args;
+
+	while (parser.nextLine(args))
+	{
+		parser.expectArgs(args, 2, "key value");
+
+		int value = parser.toInt(args[1]);
+
+		if (args[0] == "frame-budget-ms")
+			settings.budgetMs = value;
+		else if (args[0] == "min-scale")
+			settings.minScale = value;
+		else if (args[0] == "max-scale")
+			settings.maxScale = value;
+		else if (args[0] == "step")
+			settings.step = value;
+		else if (args[0] == "hysteresis")
+			settings.hysteresis = value;
+		else if (args[0] == "cooldown")
+			settings.cooldown = value;
+		else if (args[0] == "particle-budget")
+			particles::setBudget(value);
+		else if (args[0] == "texture-budget-mb")
+			textureCache::setBudget((size_t)value * 1024 * 1024);
+		else if (args[0] == "unfocused-tick-rate" || args[0] == "hidden-tick-rate")
+		{
+			// faster than the game's own rate would fast-forward gameplay
+			if (value < 0 || value > global::TICK_RATE)
+				parser.error(args[1], args[0].str() + " must be 0 to " + std::to_string(global::TICK_RATE));
+
+			powerScheduler::setTickRate(args[0] == "hidden-tick-rate" ? powerScheduler::HIDDEN : powerScheduler::UNFOCUSED, value);
+		}
+		else
+			parser.error(args[0], "unknown setting \"" + args[0].str() + "\"");
+	}
 }
@@ -2,9 +2,14 @@
 #include <map>
 #include "global.h"
 #include "gameObj.h"
+#include "resolutionScaler.h"
 
-void bulletsFromFile(std::string fileName, std::map<std::string, gameObj> &objMap);
+void bulletsFromFile(std::string fileName);
 
-void enemiesFromFile(std::string fileName, std::map<std::string, gameObj> &objMap);
+void enemiesFromFile(std::string fileName);
+
+void bossesFromFile(std::string fileName);
 
 void wavesFromFile(std::string fileName, std::vector<std::vector<gameObj>> &objMap);
+
+void videoFromFile(std::string fileName, resolutionScaler::settings &settings);
@@ -0,0 +1,282 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <SDL2/SDL.h>
+
+#include "logger.h"
+#include "configParser.h"
+
+// deepest #include nesting before we assume a cycle
+static const int MAX_INCLUDE_DEPTH = 16;
+
+static bool isSpace(const char &c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool token::operator==(const char *s) const
+{
+	return strncmp(data, s, length) == 0 && s[length] == '\0';
+}
+
+configParser::configParser(const std::string &fileName)
+{
+	open(fileName, nullptr);
+}
+
+configParser::~configParser()
+{
+	for (auto &f : files)
+	{
+		if (f.size > 0)
+			munmap((void *)f.data, f.size);
+	}
+}
+
+void configParser::open(const std::string &fileName, const token *includedAt)
+{
+	// includes are relative to the including file
+	std::string path = fileName;
+	if (includedAt != nullptr && fileName[0] != '/')
+	{
+		const std::string &parent = files[includedAt->file].name;
+		size_t slash = parent.rfind('/');
+		if (slash != std::string::npos)
+			path = parent.substr(0, slash + 1) + fileName;
+	}
+
+	if (includedAt != nullptr && includeStack.size() >= (size_t)MAX_INCLUDE_DEPTH)
+		error(*includedAt, "includes nested too deep (cycle?)");
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) < 0)
+	{
+		if (fd >= 0) close(fd);
+
+		if (includedAt != nullptr)
+			error(*includedAt, "could not open \"" + path + "\"");
+
+		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not open \""+path+"\".").c_str(), NULL);
+		LOG_ERROR("Could not open \"", path, "\"");
+		exit(EXIT_FAILURE);
+	}
+
+	mappedFile f;
+	f.name = path;
+	f.size = st.st_size;
+	f.data = "";
+
+	if (f.size > 0)
+	{
+		void *data = mmap(nullptr, f.size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			close(fd);
+			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not read \""+path+"\".").c_str(), NULL);
+			LOG_ERROR("Could not map \"", path, "\"");
+			exit(EXIT_FAILURE);
+		}
+		madvise(data, f.size, MADV_SEQUENTIAL);
+		f.data = (const char *)data;
+	}
+	close(fd);
+
+	files.push_back(f);
+
+	cursor c;
+	c.file = files.size() - 1;
+	c.pos = f.data;
+	c.line = 0;
+	includeStack.push_back(c);
+}
+
+bool configParser::nextLine(std::vector<token> &tokens)
+{
+	tokens.clear();
+
+	while (!includeStack.empty())
+	{
+		cursor &c = includeStack.back();
+		const mappedFile &f = files[c.file];
+		const char *end = f.data + f.size;
+
+		// end of file, back to includer
+		if (c.pos >= end)
+		{
+			includeStack.pop_back();
+			continue;
+		}
+
+		// find end of line
+		const char *lineStart = c.pos;
+		const char *eol = (const char *)memchr(lineStart, '\n', end - lineStart);
+		if (eol == nullptr) eol = end;
+
+		c.line++;
+		c.pos = eol < end ? eol + 1 : end;
+
+		// tokenize line
+		raw.clear();
+		for (const char *p = lineStart; p < eol;)
+		{
+			if (isSpace(*p))
+			{
+				p++;
+				continue;
+			}
+
+			token t;
+			t.data = p;
+			t.file = c.file;
+			t.line = c.line;
+			t.column = p - lineStart + 1;
+
+			while (p < eol && !isSpace(*p)) p++;
+			t.length = p - t.data;
+
+			raw.push_back(t);
+		}
+
+		if (raw.empty()) continue;
+
+		// directives and comments
+		if (raw[0].data[0] == '#')
+		{
+			if (raw[0] == "#define")
+				define(raw);
+			else if (raw[0] == "#include")
+			{
+				if (raw.size() < 2)
+					error(raw[0], "expected file name after #include");
+
+				// strip optional quotes
+				token name = raw[1];
+				if (name.length > 1 && name.data[0] == '"' && name.data[name.length - 1] == '"')
+				{
+					name.data++;
+					name.length -= 2;
+				}
+
+				open(name.str(), &raw[0]); // invalidates c
+			}
+
+			continue;
+		}
+
+		// expand macros
+		for (auto &t : raw)
+		{
+			const macro *m = findMacro(t);
+			if (m == nullptr)
+			{
+				tokens.push_back(t);
+				continue;
+			}
+
+			// expanded tokens report the use site
+			for (auto v : m->value)
+			{
+				v.file = t.file;
+				v.line = t.line;
+				v.column = t.column;
+				tokens.push_back(v);
+			}
+		}
+
+		if (!tokens.empty())
+			return true;
+	}
+
+	return false;
+}
+
+void configParser::define(const std::vector<token> &line)
+{
+	if (line.size() < 2)
+		error(line[0], "expected macro name after #define");
+
+	macro m;
+	m.name = line[1];
+
+	// value tokens may themselves use earlier macros
+	for (size_t i = 2; i < line.size(); i++)
+	{
+		const macro *inner = findMacro(line[i]);
+		if (inner != nullptr)
+			m.value.insert(m.value.end(), inner->value.begin(), inner->value.end());
+		else
+			m.value.push_back(line[i]);
+	}
+
+	// redefinition replaces
+	for (auto &existing : macros)
+	{
+		if (existing.name.length == m.name.length && !memcmp(existing.name.data, m.name.data, m.name.length))
+		{
+			existing.value = m.value;
+			return;
+		}
+	}
+
+	macros.push_back(m);
+}
+
+const configParser::macro *configParser::findMacro(const token &t) const
+{
+	for (auto &m : macros)
+	{
+		if (m.name.length == t.length && !memcmp(m.name.data, t.data, t.length))
+			return &m;
+	}
+
+	return nullptr;
+}
+
+std::string configParser::where(const token &t) const
+{
+	return files[t.file].name + ":" + std::to_string(t.line) + ":" + std::to_string(t.column);
+}
+
+void configParser::error(const token &t, const std::string &message) const
+{
+	std::string text = where(t) + ": " + message;
+
+	SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Config error", text.c_str(), NULL);
+	LOG_ERROR(text);
+	exit(EXIT_FAILURE);
+}
+
+void configParser::expectArgs(const std::vector<token> &tokens, const size_t &count, const char *usage) const
+{
+	if (tokens.size() < count)
+		error(tokens.back(), "expected " + std::to_string(count) + " values: " + usage);
+}
+
+int configParser::toInt(const token &t) const
+{
+	const char *p = t.data;
+	const char *end = t.data + t.length;
+	bool negative = false;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+
+	if (p == end)
+		error(t, "expected integer, got \"" + t.str() + "\"");
+
+	long value = 0;
+	for (; p < end; p++)
+	{
+		if (*p < '0' || *p > '9' || value > 100000000)
+			error(t, "expected integer, got \"" + t.str() + "\"");
+		value = value * 10 + (*p - '0');
+	}
+
+	return negative ? -value : value;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// config file tokenizer
+// =====================
+// Memory maps a config file and hands out one line of tokens at a time.
+// Tokens are views into the mapped buffers, nothing is copied. Lines
+// starting with # are comments, except for the preprocessor directives
+//   #define NAME value...   replace token NAME with value in later lines
+//   #include file           read file (relative to current file) in place
+
+// view of a token inside a mapped config file
+struct token {
+	const char *data;
+	int length;
+
+	// where the token was used, for error messages
+	int file;
+	int line;
+	int column;
+
+	bool operator==(const char *s) const;
+	bool operator!=(const char *s) const { return !(*this == s); }
+
+	std::string str() const { return std::string(data, length); }
+};
+
+class configParser {
+	public:
+
+	// opens fileName, shows error and exits if it can't be read
+	configParser(const std::string &fileName);
+	~configParser();
+
+	// next line with macros expanded, skips blank lines and comments
+	// returns false at end of input
+	bool nextLine(std::vector<token> &tokens);
+
+	// "file:line:column"
+	std::string where(const token &t) const;
+
+	// show error at token and exit
+	void error(const token &t, const std::string &message) const;
+
+	// error unless line has at least count tokens, usage describes the line format
+	void expectArgs(const std::vector<token> &tokens, const size_t &count, const char *usage) const;
+
+	// token as integer, error if it isn't one
+	int toInt(const token &t) const;
+
+	private:
+
+	struct mappedFile {
+		std::string name;
+		const char *data;
+		size_t size;
+	};
+
+	// read position in a file on the include stack
+	struct cursor {
+		int file;
+		const char *pos;
+		int line;
+	};
+
+	struct macro {
+		token name;
+		std::vector<token> value;
+	};
+
+	std::vector<mappedFile> files;
+	std::vector<cursor> includeStack;
+	std::vector<macro> macros;
+	std::vector<token> raw; // current line before macro expansion
+
+	// map file and push it on the include stack, includedAt is nullptr for the root file
+	void open(const std::string &fileName, const token *includedAt);
+
+	void define(const std::vector<token> &line);
+
+	const macro *findMacro(const token &t) const;
+
+	// not copyable, tokens point into our mappings
+	configParser(const configParser &);
+	configParser &operator=(const configParser &);
+};
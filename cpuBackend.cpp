@@ -0,0 +1,347 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "global.h"
+#include "logger.h"
+#include "cpuBackend.h"
+
+// premultiplied src over dst
+static inline std::uint32_t blend(const std::uint32_t &s, const std::uint32_t &d)
+{
+	std::uint32_t a = s >> 24;
+	if (a == 255) return s;
+	if (a == 0) return d;
+
+	std::uint32_t inv = 255 - a;
+	std::uint32_t rb = (d & 0x00FF00FF) * inv;
+	std::uint32_t ag = ((d >> 8) & 0x00FF00FF) * inv;
+
+	// divide by 255 with rounding
+	rb = ((rb + 0x00800080 + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+	ag = (ag + 0x00800080 + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+	return s + (rb | ag);
+}
+
+#ifdef __SSE2__
+// blend 4 premultiplied pixels
+static inline __m128i blend4(const __m128i &s, const __m128i &d)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+
+	// all transparent or all opaque
+	__m128i alpha = _mm_and_si128(s, alphaMask);
+	if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) return d;
+	if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF) return s;
+
+	// 255 - alpha in every 16 bit channel lane
+	__m128i a = _mm_srli_epi32(s, 24);
+	a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+	__m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	__m128i invLo = _mm_unpacklo_epi32(inv, inv);
+	__m128i invHi = _mm_unpackhi_epi32(inv, inv);
+
+	const __m128i round = _mm_set1_epi16(128);
+	__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), invLo), round);
+	__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), invHi), round);
+
+	// divide by 255 with rounding
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+	return _mm_adds_epu8(s, _mm_packus_epi16(lo, hi));
+}
+#endif
+
+// blend a contiguous source row
+static void blendRow(std::uint32_t *dst, const std::uint32_t *src, const int &count)
+{
+	int x = 0;
+#ifdef __SSE2__
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + x));
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+		_mm_storeu_si128((__m128i *)(dst + x), blend4(s, d));
+	}
+#endif
+	for (; x < count; x++)
+		dst[x] = blend(src[x], dst[x]);
+}
+
+// blend a source row sampled at columns
+static void blendRowScaled(std::uint32_t *dst, const std::uint32_t *src, const int *columns, const int &count)
+{
+	int x = 0;
+#ifdef __SSE2__
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i s = _mm_set_epi32(src[columns[x + 3]], src[columns[x + 2]], src[columns[x + 1]], src[columns[x]]);
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+		_mm_storeu_si128((__m128i *)(dst + x), blend4(s, d));
+	}
+#endif
+	for (; x < count; x++)
+		dst[x] = blend(src[columns[x]], dst[x]);
+}
+
+// blend one premultiplied color over a row
+static void fillRow(std::uint32_t *dst, const std::uint32_t &color, const int &count)
+{
+	int x = 0;
+#ifdef __SSE2__
+	__m128i s = _mm_set1_epi32(color);
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+		_mm_storeu_si128((__m128i *)(dst + x), blend4(s, d));
+	}
+#endif
+	for (; x < count; x++)
+		dst[x] = blend(color, dst[x]);
+}
+
+// premultiply ARGB8888 rows into dst, returns false if any pixel is translucent
+static bool premultiply(SDL_Surface *argb, std::uint32_t *dst, const int &dstPitch)
+{
+	bool opaque = true;
+
+	SDL_LockSurface(argb);
+	for (int y = 0; y < argb->h; y++)
+	{
+		const std::uint32_t *row = (const std::uint32_t *)((const std::uint8_t *)argb->pixels + y * argb->pitch);
+
+		for (int x = 0; x < argb->w; x++)
+		{
+			std::uint32_t p = row[x];
+			std::uint32_t a = p >> 24;
+
+			if (a != 255)
+			{
+				opaque = false;
+				std::uint32_t rb = (p & 0x00FF00FF) * a;
+				std::uint32_t g = (p & 0x0000FF00) * a;
+				rb = ((rb + 0x00800080 + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+				g = ((g + 0x00008000 + ((g >> 8) & 0x0000FF00)) >> 8) & 0x0000FF00;
+				p = (a << 24) | rb | g;
+			}
+
+			dst[y * dstPitch + x] = p;
+		}
+	}
+	SDL_UnlockSurface(argb);
+
+	return opaque;
+}
+
+cpuBackend::cpuBackend(SDL_Window *w)
+{
+	window = w;
+}
+
+cpuBackend::~cpuBackend()
+{
+	releaseTarget();
+}
+
+texture *cpuBackend::createTexture(SDL_Surface *surface)
+{
+	// pre-swizzle to framebuffer order
+	SDL_Surface *argb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+	if (argb == nullptr)
+		return nullptr;
+
+	cpuTexture *t = new cpuTexture();
+	t->width = argb->w;
+	t->height = argb->h;
+	t->pixels.resize(t->width * t->height);
+	t->opaque = premultiply(argb, t->pixels.data(), t->width);
+	SDL_FreeSurface(argb);
+
+	return t;
+}
+
+void cpuBackend::destroyTexture(texture *t)
+{
+	delete t;
+}
+
+void cpuBackend::updateTexture(texture *t, const SDL_Rect &area, SDL_Surface *surface)
+{
+	cpuTexture *tex = static_cast<cpuTexture *>(t);
+
+	if (area.x < 0 || area.y < 0 || area.x + surface->w > tex->width || area.y + surface->h > tex->height)
+	{
+		LOG_WARN_RATE(1, "Texture update outside texture");
+		return;
+	}
+
+	SDL_Surface *argb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+	if (argb == nullptr)
+	{
+		LOG_WARN_RATE(1, "Texture update failed: ", SDL_GetError());
+		return;
+	}
+
+	// stays opaque only if the update is
+	if (!premultiply(argb, &tex->pixels[area.y * tex->width + area.x], tex->width))
+		tex->opaque = false;
+
+	SDL_FreeSurface(argb);
+}
+
+bool cpuBackend::initTarget(const int &maxScale)
+{
+	pitch = global::SCREEN_WIDTH * maxScale / 100;
+	int rows = global::SCREEN_HEIGHT * maxScale / 100;
+
+	framebuffer.assign(pitch * rows, 0xFF000000);
+	frameSurface = SDL_CreateRGBSurfaceWithFormatFrom(framebuffer.data(), pitch, rows, 32, pitch * 4, SDL_PIXELFORMAT_ARGB8888);
+
+	if (frameSurface == nullptr)
+	{
+		LOG_ERROR("Could not create framebuffer surface: ", SDL_GetError());
+		return false;
+	}
+
+	SDL_SetSurfaceBlendMode(frameSurface, SDL_BLENDMODE_NONE);
+	return true;
+}
+
+void cpuBackend::releaseTarget()
+{
+	if (frameSurface)
+		SDL_FreeSurface(frameSurface);
+	frameSurface = nullptr;
+}
+
+void cpuBackend::beginFrame(const int &scale)
+{
+	clipW = global::SCREEN_WIDTH * scale / 100;
+	clipH = global::SCREEN_HEIGHT * scale / 100;
+
+	for (int y = 0; y < clipH; y++)
+		std::fill_n(framebuffer.begin() + y * pitch, clipW, 0xFF000000);
+}
+
+void cpuBackend::draw(const texture *t, const SDL_Rect *src, const SDL_Rect &dst)
+{
+	const cpuTexture *tex = static_cast<const cpuTexture *>(t);
+	SDL_Rect s = src ? *src : global::makeRect(0, 0, tex->width, tex->height);
+
+	if (dst.w <= 0 || dst.h <= 0 || s.w <= 0 || s.h <= 0) return;
+
+	// clip destination to frame
+	int x0 = std::max(dst.x, 0);
+	int y0 = std::max(dst.y, 0);
+	int x1 = std::min(dst.x + dst.w, clipW);
+	int y1 = std::min(dst.y + dst.h, clipH);
+	if (x0 >= x1 || y0 >= y1) return;
+
+	int width = x1 - x0;
+
+	// 16.16 source steps
+	std::int64_t stepX = ((std::int64_t)s.w << 16) / dst.w;
+	std::int64_t stepY = ((std::int64_t)s.h << 16) / dst.h;
+	bool unscaled = s.w == dst.w && s.h == dst.h;
+
+	if (!unscaled)
+	{
+		columns.resize(width);
+		for (int x = 0; x < width; x++)
+			columns[x] = s.x + (int)(((x + x0 - dst.x) * stepX) >> 16);
+	}
+
+	for (int y = y0; y < y1; y++)
+	{
+		int sy = s.y + (int)(((y - dst.y) * stepY) >> 16);
+		const std::uint32_t *srcRow = &tex->pixels[sy * tex->width];
+		std::uint32_t *dstRow = &framebuffer[y * pitch + x0];
+
+		if (!unscaled)
+			blendRowScaled(dstRow, srcRow, columns.data(), width);
+		else if (tex->opaque)
+			memcpy(dstRow, srcRow + s.x + (x0 - dst.x), width * 4);
+		else
+			blendRow(dstRow, srcRow + s.x + (x0 - dst.x), width);
+	}
+}
+
+void cpuBackend::fillRects(const SDL_Rect *rects, const int &count, const SDL_Color &color)
+{
+	// premultiply once for the whole batch
+	std::uint32_t a = color.a;
+	std::uint32_t p = (a << 24) | ((color.r * a + 127) / 255 << 16) | ((color.g * a + 127) / 255 << 8) | ((color.b * a + 127) / 255);
+
+	for (int i = 0; i < count; i++)
+	{
+		const SDL_Rect &r = rects[i];
+
+		// clip to frame
+		int x0 = std::max(r.x, 0);
+		int y0 = std::max(r.y, 0);
+		int x1 = std::min(r.x + r.w, clipW);
+		int y1 = std::min(r.y + r.h, clipH);
+		if (x0 >= x1 || y0 >= y1) continue;
+
+		for (int y = y0; y < y1; y++)
+		{
+			if (a == 255)
+				std::fill_n(&framebuffer[y * pitch + x0], x1 - x0, p);
+			else
+				fillRow(&framebuffer[y * pitch + x0], p, x1 - x0);
+		}
+	}
+}
+
+void cpuBackend::endFrame(const int &)
+{
+	SDL_Surface *windowSurface = SDL_GetWindowSurface(window);
+	if (windowSurface == nullptr)
+	{
+		LOG_WARN_RATE(1, "No window surface: ", SDL_GetError());
+		return;
+	}
+
+	SDL_Rect src = global::makeRect(0, 0, clipW, clipH);
+
+	if (clipW == windowSurface->w && clipH == windowSurface->h)
+		SDL_BlitSurface(frameSurface, &src, windowSurface, nullptr);
+	else
+		SDL_BlitScaled(frameSurface, &src, windowSurface, nullptr);
+}
+
+bool cpuBackend::readFrame(Uint32 *pixels)
+{
+	SDL_Surface *windowSurface = SDL_GetWindowSurface(window);
+	if (windowSurface == nullptr || windowSurface->w < global::SCREEN_WIDTH || windowSurface->h < global::SCREEN_HEIGHT)
+		return false;
+
+	if (SDL_MUSTLOCK(windowSurface))
+		SDL_LockSurface(windowSurface);
+
+	int result = SDL_ConvertPixels(global::SCREEN_WIDTH, global::SCREEN_HEIGHT, windowSurface->format->format, windowSurface->pixels,
+		windowSurface->pitch, SDL_PIXELFORMAT_ARGB8888, pixels, global::SCREEN_WIDTH * 4);
+
+	if (SDL_MUSTLOCK(windowSurface))
+		SDL_UnlockSurface(windowSurface);
+
+	if (result < 0)
+	{
+		LOG_WARN_RATE(1, "Frame readback failed: ", SDL_GetError());
+		return false;
+	}
+
+	return true;
+}
+
+void cpuBackend::present()
+{
+	SDL_UpdateWindowSurface(window);
+}
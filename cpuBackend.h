@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+#include "renderBackend.h"
+
+// software rasterizer drawing into a framebuffer that is blitted to the
+// window surface. Sprites are stored premultiplied in framebuffer pixel
+// order (ARGB8888) and alpha blended 4 pixels at a time with SSE2.
+class cpuBackend : public renderBackend {
+	public:
+
+	cpuBackend(SDL_Window *w);
+	~cpuBackend();
+
+	const char *name() const { return "cpu"; }
+
+	texture *createTexture(SDL_Surface *surface);
+	void destroyTexture(texture *t);
+	void updateTexture(texture *t, const SDL_Rect &area, SDL_Surface *surface);
+
+	bool initTarget(const int &maxScale);
+	void releaseTarget();
+
+	void beginFrame(const int &scale);
+	void draw(const texture *t, const SDL_Rect *src, const SDL_Rect &dst);
+	void fillRects(const SDL_Rect *rects, const int &count, const SDL_Color &color);
+	void endFrame(const int &scale);
+	bool readFrame(Uint32 *pixels);
+	void present();
+
+	private:
+
+	struct cpuTexture : public texture {
+		std::vector<std::uint32_t> pixels; // premultiplied ARGB
+		bool opaque = false; // every alpha is 255, rows can be copied
+	};
+
+	SDL_Window *window;
+
+	// framebuffer at max scale, frames use its top left corner
+	std::vector<std::uint32_t> framebuffer;
+	SDL_Surface *frameSurface = nullptr;
+	int pitch = 0; // pixels per framebuffer row
+	int clipW = 0; // current frame size
+	int clipH = 0;
+
+	std::vector<int> columns; // source x for each destination x of a scaled draw
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+struct cachedTexture;
+
+// draw layers, rendered back to front
+namespace layer {
+	enum Layers
+	{
+		BACKGROUND,
+		PLAYER,
+		BULLET,
+		ENEMY,
+		PARTICLE,
+		HUD,
+		TOTAL
+	};
+}
+
+// plain data draw command, emitted by the simulation each tick
+struct drawCmd {
+	const cachedTexture *tex; // backend texture is looked up by the render thread
+	SDL_Rect src; // w == 0 means whole texture
+	SDL_Rect dst;
+	int layer;
+};
+
+// solid color rects drawn in one backend call
+struct rectBatch {
+	SDL_Color color;
+	int layer;
+	int first; // index into drawList::rects
+	int count;
+};
+
+// all draw commands for one tick
+struct drawList {
+	std::vector<drawCmd> cmds;
+
+	std::vector<rectBatch> batches;
+	std::vector<SDL_Rect> rects;
+
+	// earliest input event this tick reflects that isn't on screen yet
+	Uint64 inputStamp = 0;
+
+	// global::ticks when submitted, numbers captured frames
+	Uint32 tick = 0;
+
+	void clear()
+	{
+		cmds.clear();
+		batches.clear();
+		rects.clear();
+		inputStamp = 0;
+	}
+};
@@ -1,8 +1,45 @@
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "baseObjects.h"
 #include "gameObj.h"
 #include "movement.h"
 #include "moveSequence.h"
+#include "textureCache.h"
+#include "bosses.h"
 
 std::vector<std::vector<gameObj>> enemyWaves;
+
+thread_local std::vector<gameObj> currentEnemies;
+
+std::vector<std::string> waveTextures(const int &wave)
+{
+	std::vector<std::string> paths;
+	if (wave < 0 || wave >= (int)enemyWaves.size())
+		return paths;
+
+	// enemies and boss parts
+	std::vector<int> types;
+	for (auto &enemy : enemyWaves[wave])
+	{
+		types.push_back(enemy.type);
+
+		if (enemy.boss >= 0)
+			for (auto &part : bosses::blueprints[enemy.boss].parts)
+				types.push_back(part.type);
+	}
+
+	for (auto &type : types)
+	{
+		const archetype &a = prototypes::get(type);
+		paths.push_back(a.texture->path);
+
+		if (a.bullet >= 0)
+			paths.push_back(prototypes::get(a.bullet).texture->path);
+	}
+
+	std::sort(paths.begin(), paths.end());
+	paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+	return paths;
+}
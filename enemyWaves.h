@@ -1,6 +1,14 @@
+#include <string>
 #include <vector>
 
 #include "gameObj.h"
 
 
+// waves as loaded from config, not modified during play, shared by threads
 extern std::vector<std::vector<gameObj>> enemyWaves;
+
+// live copy of the wave in play
+extern thread_local std::vector<gameObj> currentEnemies;
+
+// images drawn by a wave's enemies and their bullets, none if wave is out of range
+extern std::vector<std::string> waveTextures(const int &wave);
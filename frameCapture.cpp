@@ -0,0 +1,335 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "logger.h"
+#include "frameCapture.h"
+
+namespace frameCapture {
+
+// buffers in the ring, frames in flight before dropping
+static const int BUFFERS = 8;
+
+enum BufferStates
+{
+	FREE,
+	WRITING, // render thread reading back
+	QUEUED, // waiting for an encoder
+	ENCODING
+};
+
+struct frameBuffer {
+	std::atomic<int> state;
+	Uint32 frame = 0; // ticks since capture started
+	std::vector<Uint32> pixels;
+};
+
+static frameBuffer buffers[BUFFERS];
+static int writing = -1; // buffer handed out by acquire
+
+static std::string prefix;
+static bool y4m = false;
+static FILE *stream = nullptr;
+
+static std::vector<SDL_Thread *> workers;
+static SDL_sem *queued = nullptr; // one post per queued frame
+static std::atomic<bool> running(false);
+
+// frame numbers, render thread side
+static bool startedTicks = false;
+static Uint32 firstTick = 0;
+static Uint32 lastFrame = 0; // latest frame handed out or dropped
+
+// Y4M frames in the stream so far, encoder side
+static Uint32 written = 0;
+static std::vector<Uint8> planes; // last frame written
+
+// stats, render thread side
+static Uint64 captured = 0;
+static Uint64 dropped = 0;
+static double readbackMs = 0;
+static double worstReadbackMs = 0;
+static Uint64 readbackStart = 0;
+
+// stats, encoder side
+static std::atomic<Uint64> encoded(0);
+static std::atomic<Uint64> encodeMicros(0);
+static Uint64 repeated = 0;
+
+// BT.601 studio range
+static inline Uint8 lumaOf(const int &r, const int &g, const int &b)
+{
+	return (66 * r + 129 * g + 25 * b + 128) / 256 + 16;
+}
+
+// previous frame again for each tick before frame that has no frame of its own
+static void repeatY4M(const Uint32 &frame)
+{
+	if (written == 0)
+		return;
+
+	for (; written < frame; written++)
+	{
+		fputs("FRAME\n", stream);
+		fwrite(planes.data(), 1, planes.size(), stream);
+		repeated++;
+	}
+}
+
+static void writeY4M(const std::vector<Uint32> &pixels, const Uint32 &frame)
+{
+	const int WIDTH = global::SCREEN_WIDTH;
+	const int HEIGHT = global::SCREEN_HEIGHT;
+	planes.resize(WIDTH * HEIGHT * 3 / 2);
+
+	repeatY4M(frame);
+
+	Uint8 *yPlane = planes.data();
+	Uint8 *uPlane = yPlane + WIDTH * HEIGHT;
+	Uint8 *vPlane = uPlane + WIDTH * HEIGHT / 4;
+
+	for (int i = 0; i < WIDTH * HEIGHT; i++)
+	{
+		Uint32 p = pixels[i];
+		yPlane[i] = lumaOf((p >> 16) & 0xFF, (p >> 8) & 0xFF, p & 0xFF);
+	}
+
+	// 4:2:0, chroma from the average of each 2x2 block
+	for (int y = 0; y < HEIGHT; y += 2)
+	{
+		for (int x = 0; x < WIDTH; x += 2)
+		{
+			int r = 0, g = 0, b = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				Uint32 p = pixels[(y + i / 2) * WIDTH + x + i % 2];
+				r += (p >> 16) & 0xFF;
+				g += (p >> 8) & 0xFF;
+				b += p & 0xFF;
+			}
+			r /= 4; g /= 4; b /= 4;
+
+			int c = y / 2 * (WIDTH / 2) + x / 2;
+			uPlane[c] = (-38 * r - 74 * g + 112 * b + 128) / 256 + 128;
+			vPlane[c] = (112 * r - 94 * g - 18 * b + 128) / 256 + 128;
+		}
+	}
+
+	fputs("FRAME\n", stream);
+	fwrite(planes.data(), 1, planes.size(), stream);
+	written = frame + 1;
+}
+
+static void writePNG(const frameBuffer &buffer)
+{
+	SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom((void *)buffer.pixels.data(), global::SCREEN_WIDTH, global::SCREEN_HEIGHT, 32, global::SCREEN_WIDTH * 4, SDL_PIXELFORMAT_ARGB8888);
+	if (surface == nullptr)
+	{
+		LOG_WARN_RATE(1, "Capture surface failed: ", SDL_GetError());
+		return;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "%06u.png", buffer.frame);
+
+	if (IMG_SavePNG(surface, (prefix + name).c_str()) != 0)
+		LOG_WARN_RATE(1, "Could not write ", prefix + name, ": ", SDL_GetError());
+
+	SDL_FreeSurface(surface);
+}
+
+// oldest queued buffer, claimed for encoding; -1 if none
+static int claim()
+{
+	for (;;)
+	{
+		int oldest = -1;
+		for (int i = 0; i < BUFFERS; i++)
+			if (buffers[i].state.load(std::memory_order_acquire) == QUEUED && (oldest < 0 || buffers[i].frame < buffers[oldest].frame))
+				oldest = i;
+
+		if (oldest < 0)
+			return -1;
+
+		int expected = QUEUED;
+		if (buffers[oldest].state.compare_exchange_strong(expected, ENCODING, std::memory_order_acquire))
+			return oldest;
+	}
+}
+
+static int encodeLoop(void *)
+{
+	for (;;)
+	{
+		SDL_SemWait(queued);
+
+		int i = claim();
+		if (i < 0)
+		{
+			if (!running.load(std::memory_order_acquire))
+				return 0;
+			continue;
+		}
+
+		Uint64 start = SDL_GetPerformanceCounter();
+
+		if (y4m)
+			writeY4M(buffers[i].pixels, buffers[i].frame);
+		else
+			writePNG(buffers[i]);
+
+		encodeMicros += (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+		encoded++;
+
+		buffers[i].state.store(FREE, std::memory_order_release);
+	}
+}
+
+bool start(const std::string &path, const int &numWorkers)
+{
+	y4m = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+	prefix = path;
+
+	if (y4m)
+	{
+		stream = fopen(path.c_str(), "wb");
+		if (stream == nullptr)
+		{
+			LOG_ERROR("Could not open capture file ", path);
+			return false;
+		}
+
+		fprintf(stream, "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 C420jpeg\n", global::SCREEN_WIDTH, global::SCREEN_HEIGHT);
+	}
+
+	for (auto &buffer : buffers)
+	{
+		buffer.pixels.resize(global::SCREEN_WIDTH * global::SCREEN_HEIGHT);
+		buffer.state = FREE;
+	}
+
+	startedTicks = false;
+	lastFrame = 0;
+	written = 0;
+
+	queued = SDL_CreateSemaphore(0);
+	running = true;
+
+	// Y4M frames must be written in order, one writer
+	int count = y4m ? 1 : std::max(numWorkers, 1);
+	for (int i = 0; i < count; i++)
+	{
+		SDL_Thread *thread = SDL_CreateThread(encodeLoop, "capture", nullptr);
+		if (thread)
+			workers.push_back(thread);
+	}
+
+	if (workers.empty())
+	{
+		LOG_ERROR("Could not create capture thread: ", SDL_GetError());
+		stop();
+		return false;
+	}
+
+	LOG_INFO("Capturing to ", path, y4m ? "" : "NNNNNN.png");
+	return true;
+}
+
+void stop()
+{
+	if (queued == nullptr) return;
+
+	// workers drain the queue, then see running is false
+	running = false;
+	for (size_t i = 0; i < workers.size(); i++)
+		SDL_SemPost(queued);
+
+	for (auto thread : workers)
+		SDL_WaitThread(thread, nullptr);
+	workers.clear();
+
+	SDL_DestroySemaphore(queued);
+	queued = nullptr;
+
+	// ticks after the last frame that got written
+	if (stream)
+	{
+		repeatY4M(lastFrame + 1);
+		fclose(stream);
+	}
+	stream = nullptr;
+
+	for (auto &buffer : buffers)
+		std::vector<Uint32>().swap(buffer.pixels);
+	std::vector<Uint8>().swap(planes);
+}
+
+bool enabled()
+{
+	return running.load(std::memory_order_relaxed);
+}
+
+Uint32 *acquire(const Uint32 &tick)
+{
+	readbackStart = SDL_GetPerformanceCounter();
+
+	if (!startedTicks)
+	{
+		startedTicks = true;
+		firstTick = tick;
+	}
+	lastFrame = tick - firstTick;
+
+	for (int i = 0; i < BUFFERS; i++)
+	{
+		if (buffers[i].state.load(std::memory_order_acquire) == FREE)
+		{
+			buffers[i].state.store(WRITING, std::memory_order_relaxed);
+			buffers[i].frame = lastFrame;
+			writing = i;
+			return buffers[i].pixels.data();
+		}
+	}
+
+	// encoders behind
+	dropped++;
+	return nullptr;
+}
+
+void submit()
+{
+	if (writing < 0) return;
+
+	buffers[writing].state.store(QUEUED, std::memory_order_release);
+	writing = -1;
+	SDL_SemPost(queued);
+
+	double ms = (SDL_GetPerformanceCounter() - readbackStart) * 1000.0 / SDL_GetPerformanceFrequency();
+	captured++;
+	readbackMs += ms;
+	worstReadbackMs = std::max(worstReadbackMs, ms);
+}
+
+void discard()
+{
+	if (writing < 0) return;
+
+	buffers[writing].state.store(FREE, std::memory_order_release);
+	writing = -1;
+}
+
+void report()
+{
+	if (captured + dropped == 0) return;
+
+	LOG_INFO("Capture: ", captured, " frames, ", dropped, " dropped, ", repeated, " repeated, readback ",
+		captured ? readbackMs / captured : 0.0, " ms/frame avg, ", worstReadbackMs, " ms worst, encode ",
+		encoded ? encodeMicros / 1000.0 / encoded : 0.0, " ms/frame avg");
+}
+
+} // end namespace
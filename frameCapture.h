@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+
+// frame capture
+// =============
+// The render thread reads each presented frame into one of a ring of
+// preallocated buffers; worker threads encode them to a PNG sequence or a
+// Y4M stream. When every buffer is still waiting for an encoder the frame
+// is dropped, so capture never makes the render thread wait. Frames are
+// numbered by tick; the Y4M writer repeats the previous frame for every
+// tick that was dropped or never drawn, so the stream keeps 60 frames per
+// second of game time, while PNG sequences just have gaps in their names.
+namespace frameCapture {
+
+	// frames are captured at window size (SCREEN_WIDTH x SCREEN_HEIGHT),
+	// path ending in .y4m writes one raw video stream, anything else is a
+	// PNG prefix (path000000.png for the first captured tick, numbered by ticks
+	// since); PNG frames encode on several workers
+	extern bool start(const std::string &path, const int &workers = 2);
+
+	// encode queued frames and join workers
+	extern void stop();
+
+	extern bool enabled();
+
+	// render thread: window size ARGB8888 buffer for the frame of a tick, nullptr if
+	// all are busy (frame dropped); follow with submit() or discard()
+	extern Uint32 *acquire(const Uint32 &tick);
+	extern void submit();
+	extern void discard();
+
+	// captured, dropped and repeated frames, readback and encode cost per frame
+	extern void report();
+
+} // end namespace
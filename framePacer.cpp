@@ -0,0 +1,46 @@
+#include <SDL2/SDL.h>
+#include <thread>
+
+#include "framePacer.h"
+
+framePacer::framePacer(const double &periodMs)
+{
+	frequency = SDL_GetPerformanceFrequency();
+	period = (Uint64)(periodMs * frequency / 1000.0);
+	deadline = SDL_GetPerformanceCounter();
+}
+
+void framePacer::wait()
+{
+	deadline += period;
+	Uint64 now = SDL_GetPerformanceCounter();
+	waited = 0;
+
+	// late: don't try to catch up on missed ticks
+	if (now >= deadline)
+	{
+		if (now - deadline > period)
+			deadline = now;
+		return;
+	}
+
+	Uint32 remainingMs = (deadline - now) * 1000 / frequency;
+	if (remainingMs > SPIN_MS)
+		SDL_Delay(remainingMs - SPIN_MS);
+
+	while (SDL_GetPerformanceCounter() < deadline)
+		std::this_thread::yield();
+
+	waited = SDL_GetPerformanceCounter() - now;
+}
+
+void framePacer::setPeriod(const double &periodMs)
+{
+	period = (Uint64)(periodMs * frequency / 1000.0);
+	deadline = SDL_GetPerformanceCounter();
+}
+
+double framePacer::waitedMs() const
+{
+	return waited * 1000.0 / frequency;
+}
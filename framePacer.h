@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// waits for fixed tick deadlines instead of sleeping a fixed time, so time
+// spent simulating doesn't stretch the tick. Sleeps coarsely, then spins
+// the last SPIN_MS to wake close to the deadline.
+class framePacer {
+	public:
+
+	framePacer(const double &periodMs);
+
+	// block until the next tick deadline
+	void wait();
+
+	// ms the last wait() blocked for, 0 if it was late
+	double waitedMs() const;
+
+	// change tick length, next deadline is one new period from now
+	void setPeriod(const double &periodMs);
+
+	private:
+
+	static const int SPIN_MS = 2;
+
+	Uint64 frequency;
+	Uint64 period; // performance counter ticks
+	Uint64 deadline;
+	Uint64 waited = 0;
+};
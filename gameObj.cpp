@@ -6,7 +6,8 @@
 #include <utility>
 #include "baseObjects.h"
 #include "global.h"
-#include "debug.h"
+#include "logger.h"
+#include "animations.h"
 
 #include "gameObj.h"
 
@@ -19,16 +20,14 @@ gameObj::gameObj()
 	rect = global::makeRect(0, 0, 1, 1);
 };
 
-// detailed constructor
-// takes texture string, velocity, width, height, xPos, yPos, bullet string, bullet duration, animation list
-gameObj::gameObj(std::string t, const double& vel, const int &width, const int &height, const int &xPos,const int &yPos, std::string bull, const int& dur, const std::initializer_list<animPair> &seq) 
+// archetype constructor
+// takes archetype id, xPos, yPos, animation sequence
+gameObj::gameObj(const int &archetypeId, const int &xPos, const int &yPos, const std::vector<animPair> &seq)
 {
-	currentTexture = t;
-	velocity = vel;
-	bullet = bull;
-	duration = dur;
+	type = archetypeId;
+	spawned = global::ticks;
 	animationSequence = seq;
-	rect = global::makeRect(xPos, yPos, width, height);
+	rect = global::makeRect(xPos, yPos, proto().width, proto().height);
 	initialX = xPos;
 	initialY = yPos;
 };
@@ -37,15 +36,14 @@ gameObj::gameObj(std::string t, const double& vel, const int &width, const int &
 // takes rhs gameObj, xPos, yPos, animation sequence
 gameObj::gameObj(const gameObj& other, const int &xPos, const int &yPos, const std::vector<animPair> &seq)
 {
-	currentTexture = other.currentTexture;
-	velocity = other.velocity;
-	bullet = other.bullet;
+	type = other.type;
+	boss = other.boss;
+	spawned = global::ticks;
 	animationSequence = seq;
 	
 	rect = global::makeRect(xPos, yPos, other.rect.w, other.rect.h);
 	initialX = rect.x;
 	initialY = rect.y;
-	duration = other.duration;
 };
 
 void gameObj::addAnimationSet(const std::vector<bool (*)(gameObj*)> &set, const int &distance)
@@ -80,12 +78,14 @@ bool gameObj::isOffscreen() const {
 };
 
 // get bullet
-gameObj gameObj::getBulletCopy()
+gameObj gameObj::getBulletCopy() const
 { 
-	assert(bullet != "");
-	gameObj newBullet = baseBullets[bullet]; // copy of bullet
-	newBullet.rect.x =  rect.x + rect.w/2 - 8; // center bullet
-	newBullet.rect.y = rect.y;
+	assert(proto().bullet >= 0);
+	return gameObj(proto().bullet, rect.x + rect.w/2 - 8, rect.y); // center bullet
+}
 
-	return newBullet;
+bool gameObj::draw(const int &layer) const
+{
+	const archetype &a = proto();
+	return global::render(a.texture, &rect, layer, animations::at(a.animation, global::ticks - spawned));
 }
@@ -8,7 +8,9 @@
 #include <utility>
 #include "baseObjects.h"
 #include "global.h"
-#include "debug.h"
+#include "logger.h"
+
+class gameObj;
 
 typedef std::vector<bool (*)(gameObj*)> animVector;
 typedef std::pair<animVector, int> animPair;
@@ -18,16 +20,19 @@ typedef std::pair<animVector, int> animPair;
 class gameObj {
 	public:
 
-	std::string currentTexture;
+	int type = -1; // archetype id, texture, speed and weapon live there
+
+	bool canFire = true; // cooldown timer has expired
+
+	bool grazed = false; // enemy bullet already scored a graze
 
-	std::string bullet = "";
+	Uint32 id = 0; // entity slot, identifies the object to timers
 
-	// fire rate members
-	int duration = 0; // duration of old bullet on screen
-	int timeout = 0; // time before bullet shoul be fired
+	Uint32 spawned = 0; // tick it entered play, animations count from here
+
+	int boss = -1; // blueprint when this is a boss's root part
 
 	SDL_Rect rect; // obj rect (used for coordinates)
-	double velocity = 1;
 	double velocityMod = 1;
 
 	// starting position
@@ -40,9 +45,9 @@ class gameObj {
 	// default constructor
 	gameObj();
 
-	// detailed constructor
-	// takes texture string, velocity, width, height, xPos, yPos, bullet string, bullet duration, animation list
-	gameObj(std::string t, const double& vel, const int &width, const int &height, const int &xPos = 0 ,const int &yPos = 0, std::string bull = "", const int& dur = 0, const std::initializer_list<animPair> &seq = {});
+	// archetype constructor
+	// takes archetype id, xPos, yPos, animation sequence
+	gameObj(const int &archetypeId, const int &xPos = 0, const int &yPos = 0, const std::vector<animPair> &seq = {});
 
 	// copy constructor with rect coords
 	// takes rhs gameObj, xPos, yPos, animation sequence
@@ -65,9 +70,12 @@ class gameObj {
 		initialY = y;
 	}
 
-	void resetTimeout() { timeout = duration + SDL_GetTicks(); }
+	const archetype &proto() const { return prototypes::get(type); }
+
+	// queue for drawing, at its animation frame for this tick
+	bool draw(const int &layer) const;
 
 	// get bullet
-	gameObj getBulletCopy();
+	gameObj getBulletCopy() const;
 
 };
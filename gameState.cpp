@@ -0,0 +1,425 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <vector>
+
+#include "global.h"
+#include "gameObj.h"
+#include "movement.h"
+#include "bulletContainers.h"
+#include "enemyWaves.h"
+#include "telemetry.h"
+#include "particles.h"
+#include "gameState.h"
+
+#include "getPlayerInput.h"
+#include "renderEnemies.h"
+#include "renderBullets.h"
+
+namespace gameState {
+
+// ms before first wave
+static const Uint32 START_DELAY = 1000;
+
+// ms dead before respawn, ms invulnerable after
+static const Uint32 DEATH_DELAY = 500;
+static const Uint32 INVULNERABLE_DELAY = 1000;
+
+// px between hitbox and an enemy bullet that counts as a graze
+static const int GRAZE_RADIUS = 24;
+
+// px per bullet index cell, a few bullet widths
+static const int INDEX_CELL = 32;
+
+thread_local std::vector<playerState> players;
+
+thread_local timerWheel timers;
+
+thread_local spatialIndex bulletIndex(global::SCREEN_WIDTH, global::SCREEN_HEIGHT, INDEX_CELL);
+
+static thread_local int waveIndex = 0; // index into enemyWaves of wave in play
+static thread_local int activeWave = -1; // wave copied into currentEnemies
+static thread_local bool wavesStarted = false; // start delay is over
+
+static thread_local std::vector<timer> expired; // scratch for timers due this tick
+static thread_local std::vector<int> nearby; // scratch for bullet queries
+
+// player archetypes, shared by threads
+static int shipType = -1;
+static int hitboxType = -1;
+
+void definePlayers()
+{
+	int bullet = prototypes::find("red");
+	if (bullet < 0)
+	{
+		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", "Players fire \"red\" bullets, but no bullet has that label.", NULL);
+		LOG_ERROR("No \"red\" bullet for players");
+		exit(EXIT_FAILURE);
+	}
+
+	shipType = prototypes::define(archetype("player", "assets/player.png", 8, 50, 85, bullet, 100));
+	hitboxType = prototypes::define(archetype("hitbox", "assets/hitbox.png", 8, 10, 10));
+}
+
+void init(const int &numPlayers)
+{
+	global::ticks = 0;
+	global::kills = 0;
+	global::shotsFired = 0;
+	global::distanceTraveled = 0;
+	currentPlayerBullets.clear();
+	currentEnemyBullets.clear();
+	nextEnemyBulletId = 1;
+	bulletIndex.clear();
+
+	players.clear();
+
+	for (int i = 0; i < numPlayers; i++)
+	{
+		// spread players around screen middle
+		int offset = (i * 2 - (numPlayers - 1)) * 60;
+
+		playerState p;
+		p.ship = gameObj(shipType, global::SCREEN_WIDTH / 2 - 10 / 2 + offset, global::SCREEN_HEIGHT / 2 - 100 / 2);
+		p.hitbox = gameObj(hitboxType);
+		p.ship.id = i;
+		players.push_back(p);
+	}
+
+	waveIndex = 0;
+	activeWave = -1;
+	wavesStarted = false;
+	currentEnemies.clear();
+	currentBosses.clear();
+
+	timers = timerWheel();
+	timers.add(global::ticks + global::msToTicks(START_DELAY), TIMER_WAVES_START, 0);
+}
+
+static bool byId(const gameObj &enemy, const Uint32 &id)
+{
+	return enemy.id < id;
+}
+
+// apply a timer that came due
+static void expire(const timer &t)
+{
+	switch (t.kind)
+	{
+	case TIMER_PLAYER_FIRE:
+		players[t.target].ship.canFire = true;
+		break;
+
+	case TIMER_ENEMY_FIRE:
+	{
+		// enemies stay sorted by id, a missing one was destroyed
+		auto enemy = std::lower_bound(currentEnemies.begin(), currentEnemies.end(), t.target, byId);
+		if (enemy != currentEnemies.end() && enemy->id == t.target)
+			enemy->canFire = true;
+		break;
+	}
+
+	case TIMER_RESPAWN:
+		players[t.target].isDead = false;
+		players[t.target].isInvulnerable = true;
+		timers.add(global::ticks + global::msToTicks(INVULNERABLE_DELAY), TIMER_VULNERABLE, t.target);
+		break;
+
+	case TIMER_VULNERABLE:
+		players[t.target].isInvulnerable = false;
+		break;
+
+	case TIMER_WAVES_START:
+		wavesStarted = true;
+		break;
+
+	case TIMER_PART_FIRE:
+		bosses::partCanFire(t.target);
+		break;
+	}
+}
+
+static bool advanceWorld()
+{
+	global::ticks++;
+
+	// cooldowns, respawns and wave start due this tick
+	expired.clear();
+	timers.advance(global::ticks, expired);
+	for (auto &t : expired)
+		expire(t);
+
+	bool anyAlive = false;
+	for (auto &p : players)
+		if (!p.isDead)
+			anyAlive = true;
+
+	// everyone dead, remove bullets until respawn
+	if (!anyAlive)
+		currentEnemyBullets.clear();
+
+	// render bullets
+	// ==============
+	if (anyAlive)
+	{
+		renderBullets(currentPlayerBullets);
+		renderBullets(currentEnemyBullets);
+
+		// sample enemy bullet positions for density maps
+		if (global::ticks % telemetry::SAMPLE_INTERVAL == 0)
+			for (auto &bullet : currentEnemyBullets)
+				telemetry::record(telemetry::EVENT_BULLET, bullet.rect.x + bullet.rect.w / 2, bullet.rect.y + bullet.rect.h / 2);
+	}
+
+	// render enemies
+	if (!wavesStarted) // starting game delay
+		return true;
+
+	if (waveIndex >= (int)enemyWaves.size())
+		return false; // all waves completed, game ends
+
+	// wave enters play
+	if (waveIndex != activeWave)
+	{
+		activeWave = waveIndex;
+		currentEnemies = enemyWaves[waveIndex];
+		for (size_t i = 0; i < currentEnemies.size(); i++)
+		{
+			currentEnemies[i].id = enemyId(waveIndex, i);
+			currentEnemies[i].spawned = global::ticks;
+		}
+		bosses::spawn(waveIndex, currentEnemies);
+
+		telemetry::setWave(waveIndex);
+		telemetry::record(telemetry::EVENT_WAVE_START, 0, 0, currentEnemies.size());
+		for (auto &enemy : currentEnemies)
+			telemetry::record(telemetry::EVENT_SPAWN, enemy.rect.x, enemy.rect.y);
+	}
+
+	if (currentEnemies.size() > 0)
+	{
+		renderEnemies(currentEnemies, currentPlayerBullets);
+		bosses::step(currentEnemies, currentPlayerBullets);
+	}
+	else
+	{
+		telemetry::record(telemetry::EVENT_WAVE_END, 0, 0);
+		waveIndex++;
+	}
+
+	return true;
+}
+
+bool stepWorld()
+{
+	bool running = advanceWorld();
+
+	// every bullet for this tick has moved or been fired
+	bulletIndex.refresh(currentEnemyBullets);
+	return running;
+}
+
+void stepPlayers(const playerInput *inputs)
+{
+	bool died = false;
+
+	for (size_t i = 0; i < players.size(); i++)
+	{
+		playerState &p = players[i];
+		if (p.isDead) continue;
+
+		getPlayerInput(p.ship, inputs[i]);
+
+		// update hitbox position to middle of player
+		p.hitbox.rect.x = (p.ship.rect.x + p.ship.rect.w / 2 - 4);
+		p.hitbox.rect.y = (p.ship.rect.y + p.ship.rect.h / 2 - 4);
+
+		// render player
+		if (p.isInvulnerable) // check invulnerability after respawn
+			movement::blink(&p.ship);
+		else
+		{
+			p.ship.draw(layer::PLAYER);
+			p.hitbox.draw(layer::PLAYER);
+		}
+
+		// check for enemy bullet collision (hitbox is player middle)
+		if (p.isInvulnerable) continue;
+
+		bulletIndex.within(p.hitbox.rect, 0, nearby);
+		for (auto &b : nearby)
+		{
+			global::collisionTests++;
+			if (SDL_HasIntersection(&p.hitbox.rect, &currentEnemyBullets[b].rect))
+			{
+				p.isDead = true;
+				p.deaths++;
+				timers.add(global::ticks + global::msToTicks(DEATH_DELAY), TIMER_RESPAWN, i);
+				telemetry::record(telemetry::EVENT_DEATH, p.hitbox.rect.x, p.hitbox.rect.y, i);
+
+				// explode and cancel enemy bullets once all players are checked
+				died = true;
+				particles::emit(particles::PLAYER_DEATH, p.hitbox.rect.x + p.hitbox.rect.w / 2, p.hitbox.rect.y + p.hitbox.rect.h / 2);
+				for (auto &cancelled : currentEnemyBullets)
+					particles::emit(particles::BULLET_CANCEL, cancelled.rect.x + cancelled.rect.w / 2, cancelled.rect.y + cancelled.rect.h / 2);
+				break;
+			}
+		}
+
+		if (p.isDead) continue;
+
+		// near misses score once per bullet
+		bulletIndex.within(p.hitbox.rect, GRAZE_RADIUS, nearby);
+		for (auto &b : nearby)
+		{
+			gameObj &bullet = currentEnemyBullets[b];
+			if (!bullet.grazed)
+			{
+				bullet.grazed = true;
+				p.grazes++;
+			}
+		}
+	}
+
+	// a death clears the screen once, a surviving co-op player then plays on
+	if (died)
+		currentEnemyBullets.clear();
+}
+
+void save(snapshot &s)
+{
+	s.ticks = global::ticks;
+	s.kills = global::kills;
+	s.shotsFired = global::shotsFired;
+	s.distanceTraveled = global::distanceTraveled;
+
+	s.waveIndex = waveIndex;
+	s.activeWave = activeWave;
+	s.wavesStarted = wavesStarted;
+	s.timers = timers;
+	s.enemies = currentEnemies;
+	s.bosses = currentBosses;
+	s.playerBullets = currentPlayerBullets;
+	s.enemyBullets = currentEnemyBullets;
+	s.nextEnemyBulletId = nextEnemyBulletId;
+	s.players = players;
+}
+
+void restore(const snapshot &s)
+{
+	global::ticks = s.ticks;
+	global::kills = s.kills;
+	global::shotsFired = s.shotsFired;
+	global::distanceTraveled = s.distanceTraveled;
+
+	waveIndex = s.waveIndex;
+	activeWave = s.activeWave;
+	wavesStarted = s.wavesStarted;
+	timers = s.timers;
+	currentEnemies = s.enemies;
+	currentBosses = s.bosses;
+	currentPlayerBullets = s.playerBullets;
+	currentEnemyBullets = s.enemyBullets;
+	nextEnemyBulletId = s.nextEnemyBulletId;
+	players = s.players;
+}
+
+// FNV-1a over one value
+static inline void mix(Uint32 &h, const Uint32 &value)
+{
+	for (int i = 0; i < 4; i++)
+		h = (h ^ ((value >> (i * 8)) & 0xFF)) * 16777619u;
+}
+
+static void mixRect(Uint32 &h, const SDL_Rect &r)
+{
+	mix(h, r.x); mix(h, r.y); mix(h, r.w); mix(h, r.h);
+}
+
+static void mixObjects(Uint32 &h, const std::vector<gameObj> &objects)
+{
+	mix(h, objects.size());
+	for (auto &o : objects)
+	{
+		mix(h, o.type);
+		mix(h, o.id);
+		mix(h, o.canFire);
+		mix(h, o.grazed);
+		mixRect(h, o.rect);
+	}
+}
+
+Uint32 checksum(const snapshot &s)
+{
+	Uint32 h = 2166136261u;
+
+	mix(h, s.ticks);
+	mix(h, s.kills);
+	mix(h, s.shotsFired);
+	mix(h, s.distanceTraveled);
+	mix(h, s.waveIndex);
+	mix(h, s.activeWave);
+	mix(h, s.wavesStarted);
+	mix(h, s.nextEnemyBulletId);
+
+	mixObjects(h, s.enemies);
+	mixObjects(h, s.playerBullets);
+	mixObjects(h, s.enemyBullets);
+
+	for (auto &b : s.bosses)
+	{
+		mix(h, b.id);
+		for (size_t i = 0; i < b.alive.size(); i++)
+		{
+			mix(h, b.alive[i]);
+			mixRect(h, b.world[i]);
+		}
+	}
+
+	for (auto &p : s.players)
+	{
+		mixRect(h, p.ship.rect);
+		mix(h, p.isDead);
+		mix(h, p.isInvulnerable);
+		mix(h, p.deaths);
+		mix(h, p.grazes);
+	}
+
+	return h;
+}
+
+int deaths()
+{
+	int total = 0;
+	for (auto &p : players)
+		total += p.deaths;
+	return total;
+}
+
+int grazes()
+{
+	int total = 0;
+	for (auto &p : players)
+		total += p.grazes;
+	return total;
+}
+
+int wavesCleared()
+{
+	return waveIndex;
+}
+
+int currentWave()
+{
+	return wavesStarted && waveIndex < (int)enemyWaves.size() ? waveIndex : -1;
+}
+
+int numEnemies()
+{
+	int total = 0;
+	for (auto &w : enemyWaves)
+		total += w.size();
+	return total;
+}
+
+} // end namespace
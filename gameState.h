@@ -0,0 +1,95 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "gameObj.h"
+#include "playerInput.h"
+#include "timerWheel.h"
+#include "spatialIndex.h"
+#include "bosses.h"
+
+// a player ship and its life state
+struct playerState {
+	gameObj ship;
+	gameObj hitbox;
+
+	bool isDead = false;
+	bool isInvulnerable = false;
+
+	int deaths = 0;
+	int grazes = 0; // enemy bullets passed within GRAZE_RADIUS of the hitbox
+};
+
+// simulation
+// ==========
+// A tick is stepWorld() followed by stepPlayers(). Both only read
+// simulation time and inputs, so the same inputs replay the same ticks.
+namespace gameState {
+
+	extern thread_local std::vector<playerState> players;
+
+	// what a gameplay timer does when it expires, target is the entity slot
+	enum TimerKinds
+	{
+		TIMER_PLAYER_FIRE, // player index can fire again
+		TIMER_ENEMY_FIRE, // enemy id can fire again
+		TIMER_RESPAWN, // player index comes back
+		TIMER_VULNERABLE, // player index loses spawn protection
+		TIMER_WAVES_START, // first wave enters play
+		TIMER_PART_FIRE // boss part can fire again, target from bosses::partTarget
+	};
+
+	// enemy bullets by position, refreshed at the end of stepWorld
+	extern thread_local spatialIndex bulletIndex;
+
+	// every timed gameplay event, advanced once per tick by stepWorld
+	extern thread_local timerWheel timers;
+
+	// enemy ids: wave index in the high bits, position in wave below
+	inline Uint32 enemyId(const int &wave, const int &index) { return (Uint32)wave << 16 | index; }
+
+	// complete copy of the mutable simulation state, for rollback
+	struct snapshot {
+		Uint32 ticks = 0;
+		int kills = 0;
+		int shotsFired = 0;
+		int distanceTraveled = 0;
+
+		int waveIndex = 0;
+		int activeWave = -1;
+		bool wavesStarted = false;
+		timerWheel timers;
+		std::vector<gameObj> enemies;
+		std::vector<bossState> bosses;
+		std::vector<gameObj> playerBullets;
+		std::vector<gameObj> enemyBullets;
+		Uint32 nextEnemyBulletId = 1;
+		std::vector<playerState> players;
+	};
+
+	// player ship and hitbox archetypes, once after bullets are loaded
+	extern void definePlayers();
+
+	// reset simulation and place players, call after configs are loaded
+	extern void init(const int &numPlayers);
+
+	// advance enemies, bullets and waves; false once all waves are cleared
+	extern bool stepWorld();
+
+	// move players with this tick's inputs (one per player) and check hits
+	extern void stepPlayers(const playerInput *inputs);
+
+	extern void save(snapshot &s);
+	extern void restore(const snapshot &s);
+
+	// hash of the simulation in a snapshot, equal on peers that agree
+	extern Uint32 checksum(const snapshot &s);
+
+	// stats
+	extern int deaths();
+	extern int grazes();
+	extern int wavesCleared();
+	extern int currentWave(); // wave in play, -1 before start and after end
+	extern int numEnemies();
+
+} // end namespace
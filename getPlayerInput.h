@@ -3,51 +3,58 @@
 #include "global.h"
 #include "gameObj.h"
 #include "bulletContainers.h"
+#include "playerInput.h"
+#include "telemetry.h"
+#include "gameState.h"
 #include <SDL2/SDL.h>
 
-void getPlayerInput(gameObj& player, const Uint8* keyState)
+void getPlayerInput(gameObj& player, const playerInput &input)
 {
-	// player keybindings
-	// ==================
 	// slow down
-	if (keyState[SDL_SCANCODE_LSHIFT])
+	if (input & INPUT_SLOW)
 		player.velocityMod = (.35);
 	else
 		player.velocityMod = (1);
 
+	double speed = player.proto().velocity * player.velocityMod;
+
 	// fire
-	if (keyState[SDL_SCANCODE_Z] && SDL_TICKS_PASSED(SDL_GetTicks(), player.timeout))
+	if ((input & INPUT_FIRE) && player.canFire)
 	{
 		global::shotsFired++;
 		currentPlayerBullets.push_back(player.getBulletCopy());
-		player.resetTimeout();
+		telemetry::record(telemetry::EVENT_FIRE, player.rect.x, player.rect.y, 0);
+
+		// cooldown, player id is its index
+		player.canFire = false;
+		gameState::timers.add(global::ticks + global::msToTicks(player.proto().duration), gameState::TIMER_PLAYER_FIRE, player.id);
 	}
 
 	// move left
-	if (keyState[SDL_SCANCODE_LEFT] && player.getRectL() > 0)
+	if ((input & INPUT_LEFT) && player.getRectL() > 0)
 	{
 		global::distanceTraveled++;
-		player.rect.x += -player.velocity * player.velocityMod;
+		player.rect.x += -speed;
 	}
 
 	// move right
-	if (keyState[SDL_SCANCODE_RIGHT] && player.getRectR() < global::SCREEN_WIDTH)
+	if ((input & INPUT_RIGHT) && player.getRectR() < global::SCREEN_WIDTH)
 	{
 		global::distanceTraveled++;
-		player.rect.x += player.velocity * player.velocityMod;
+		player.rect.x += speed;
 	}
 
 	// move up
-	if (keyState[SDL_SCANCODE_UP] && player.getRectTop() > 0)
+	if ((input & INPUT_UP) && player.getRectTop() > 0)
 	{
 		global::distanceTraveled++;
-		player.rect.y += -player.velocity * player.velocityMod;
+		player.rect.y += -speed;
 	}
 
 	// move down
-	if (keyState[SDL_SCANCODE_DOWN] && player.getRectBottom() < global::SCREEN_HEIGHT)
+	if ((input & INPUT_DOWN) && player.getRectBottom() < global::SCREEN_HEIGHT)
 	{
 		global::distanceTraveled++;
-		player.rect.y += player.velocity * player.velocityMod;
+		player.rect.y += speed;
 	}
 }
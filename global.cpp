@@ -1,6 +1,10 @@
 #include "global.h"
-#include "debug.h"
+#include "assetPack.h"
+#include "logger.h"
 #include "baseObjects.h"
+#include "renderThread.h"
+#include "renderBackend.h"
+#include "textureCache.h"
 #include <sstream>
 #include <fstream>
 #include <iostream>
@@ -18,21 +22,39 @@ Uint8 screenMode = SCREEN_WINDOWED;
 const int SCREEN_WIDTH = 800;
 const int SCREEN_HEIGHT = 600;
 
-int kills = 0;
-int shotsFired = 0;
+thread_local int kills = 0;
+thread_local int shotsFired = 0;
 
-int distanceTraveled = 0;
+thread_local int distanceTraveled = 0;
+
+thread_local Uint32 ticks = 0;
+
+thread_local Uint64 collisionTests = 0;
+
+thread_local bool resimulating = false;
+
+const int TICK_RATE = 60;
+
+bool headless = false;
 
 SDL_Window *window = nullptr; // main window
 SDL_Surface *windowSurface = nullptr; // surface for main window
-SDL_Renderer *renderer = nullptr; // main renderer
-
-std::map<std::string, SDL_Texture*> allTextures;
+renderBackend *backend = nullptr; // main renderer
 
 
 // functions
 // =========
 
+Uint32 now()
+{
+	return (Uint64)ticks * 1000 / TICK_RATE;
+}
+
+Uint32 msToTicks(const int &ms)
+{
+	return ((Uint64)ms * TICK_RATE + 999) / 1000;
+}
+
 // SDL rect wrapper
 SDL_Rect makeRect(const int &xPos, const int &yPos, const int &width, const int &height)
 {
@@ -46,33 +68,44 @@ SDL_Rect makeRect(const int &xPos, const int &yPos, const int &width, const int
 	return rect;
 }
 
-bool render(const std::string texture, const SDL_Rect *rect)
+bool render(cachedTexture *texture, const SDL_Rect *rect, const int &layer, const SDL_Rect *src)
 {
-	if (SDL_RenderCopy(global::renderer, global::allTextures[texture], nullptr, rect) == 0)
+	if (resimulating || headless)
 		return true;
-	else
+
+	cachedTexture *found = textureCache::get(texture);
+	if (found == nullptr)
 		return false;
+
+	drawCmd cmd;
+	cmd.tex = found;
+	cmd.src = src ? *src : makeRect(0, 0, 0, 0);
+	cmd.dst = *rect;
+	cmd.layer = layer;
+
+	renderThread::currentList().cmds.push_back(cmd);
+	return true;
 }
 
-bool init(SDL_Window *&window, SDL_Surface *&windowSurface)
+bool init(SDL_Window *&window, SDL_Surface *&windowSurface, const std::string &backendName)
 {
-	DEBUG_MSG("** Begin init **");
+	LOG_DEBUG("** Begin init **");
 
 	// init video
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
-		DEBUG_MSG("SDL could not init video: " << SDL_GetError());
+		LOG_ERROR("SDL could not init video: ", SDL_GetError());
 		return false;
 	}
-	DEBUG_MSG("Init video");
+	LOG_DEBUG("Init video");
 
 	// init PNG loading
 	if (!IMG_Init(IMG_INIT_PNG))
 	{
-		DEBUG_MSG("Could not init PNG loading: " << SDL_GetError());
+		LOG_ERROR("Could not init PNG loading: ", SDL_GetError());
 		return false;
 	}
-	DEBUG_MSG("Init PNG loading");
+	LOG_DEBUG("Init PNG loading");
 
 	// create window
 	window = SDL_CreateWindow("Bullet Hell",
@@ -84,26 +117,30 @@ bool init(SDL_Window *&window, SDL_Surface *&windowSurface)
 
 	if (window == nullptr)
 	{
-		DEBUG_MSG("SDL window creation error: " << SDL_GetError());
+		LOG_ERROR("SDL window creation error: ", SDL_GetError());
 		return false;
 	}
-	DEBUG_MSG("Created window: w: " << SCREEN_WIDTH << " h: " << SCREEN_HEIGHT );
+	LOG_DEBUG("Created window: w: ", SCREEN_WIDTH, " h: ", SCREEN_HEIGHT);
 
 	// init renderer
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	backend = createBackend(backendName, window);
 
-	if (renderer == nullptr)
+	if (backend == nullptr && backendName == "sdl")
 	{
-		DEBUG_MSG("Could not init renderer: " << SDL_GetError());
-		return false;
+		LOG_WARN("Falling back to cpu renderer");
+		backend = createBackend("cpu", window);
 	}
-	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
-	DEBUG_MSG("Init renderer");
 
-	// assign window surface
-	windowSurface = SDL_GetWindowSurface(window);
+	if (backend == nullptr)
+		return false;
+
+	LOG_INFO("Init renderer: ", backend->name());
+
+	// window surface belongs to the cpu renderer, SDL_Renderer windows have none
+	if (std::string(backend->name()) == "cpu")
+		windowSurface = SDL_GetWindowSurface(window);
 
-	DEBUG_MSG("** End init **");
+	LOG_DEBUG("** End init **");
 
 	return true;
 }
@@ -116,7 +153,7 @@ SDL_Surface *loadImage(const char fileName[])
 
 	if (imageSurface == nullptr)
 	{
-		DEBUG_MSG("Unable to load image " << fileName << ": " << SDL_GetError());
+		LOG_ERROR("Unable to load image ", fileName, ": ", SDL_GetError());
 		return nullptr;
 	}
 
@@ -124,38 +161,31 @@ SDL_Surface *loadImage(const char fileName[])
 	optimizedSurface = SDL_ConvertSurface(imageSurface, windowSurface->format, 0);
 	if (optimizedSurface == nullptr)
 	{
-		DEBUG_MSG("Unable to optimize surface " << fileName << ": " << SDL_GetError());
+		LOG_ERROR("Unable to optimize surface ", fileName, ": ", SDL_GetError());
 		return nullptr;
 	}
 
 	// free unoptimized surface
 	SDL_FreeSurface(imageSurface);
 
-	DEBUG_MSG("Load image successful: " << fileName);
+	LOG_DEBUG("Load image successful: ", fileName);
 
 	return optimizedSurface;
 }
 
-// IMG_LoadTexture wrapper
-SDL_Texture *loadTexture(const char fileName[])
+bool close()
 {
-	SDL_Texture *texture = IMG_LoadTexture(renderer, fileName);
+	// renderer belongs to the render thread until it exits
+	renderThread::stop();
 
-	if (texture == nullptr)
-	{
-		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not load \""+std::string(fileName)+"\".").c_str(), NULL);
-		DEBUG_MSG("Unable to load texture: " << fileName << " : " << SDL_GetError());
-		exit(EXIT_FAILURE);
-		return nullptr;
-	}
-
-	DEBUG_MSG("Load texture successful: " << fileName);
+	// Destroy textures
+	textureCache::clear();
+	assetPack::close();
 
-	return texture;
-}
+	// Destroy renderer
+	delete backend;
+	backend = nullptr;
 
-bool close()
-{
 	//Deallocate windowSurface
 	SDL_FreeSurface(windowSurface);
 	windowSurface = nullptr;
@@ -164,18 +194,11 @@ bool close()
 	SDL_DestroyWindow(window);
 	window = nullptr;
 
-	// Destroy renderer
-	SDL_DestroyRenderer(renderer);
-
-	// Destroy textures
-	for (auto &texture : allTextures)
-		SDL_DestroyTexture(texture.second);
-
 	//Quit SDL subsystems
 	IMG_Quit();
 	SDL_Quit();
 
-	DEBUG_MSG("Close successful");
+	LOG_DEBUG("Close successful");
 	return true;
 }
 
@@ -3,8 +3,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include "drawList.h"
 
 class gameObj;
+class renderBackend;
+struct cachedTexture;
 namespace global {
 
 	extern const Uint8 SCREEN_WINDOWED, SCREEN_FULL;
@@ -14,12 +17,30 @@ namespace global {
 	extern const int SCREEN_HEIGHT;
 	extern const int SCREEN_WIDTH;
 
+	// simulation state is per thread, so batch runs can simulate in parallel
+	// ========================================================================
+
 	// number of kills, shots
-	extern int shotsFired;
-	extern int kills;
+	extern thread_local int shotsFired;
+	extern thread_local int kills;
 
 	// distance traveled
-	extern int distanceTraveled;
+	extern thread_local int distanceTraveled;
+
+	// number of simulated ticks
+	extern thread_local Uint32 ticks;
+
+	// rect pairs tested for hits, counts resimulated ticks too; not rolled back
+	extern thread_local Uint64 collisionTests;
+
+	// true while replaying ticks for rollback, draws and telemetry are dropped
+	extern thread_local bool resimulating;
+
+	// simulated ticks per second
+	extern const int TICK_RATE;
+
+	// simulate without drawing or effects (batch runs), set before simulating
+	extern bool headless;
 
 	// keypress enum for relating textures to keypress events
 	enum KeyPresses
@@ -34,29 +55,32 @@ namespace global {
 
 	extern SDL_Window *window; // main window
 	extern SDL_Surface *windowSurface; // surface for main window
-	extern SDL_Renderer *renderer; // main renderer
-
-	extern std::map<std::string, SDL_Texture*> allTextures;
+	extern renderBackend *backend; // main renderer
 
 
 	// function prototypes
 	// ===================
 
+	// simulation time in ms, derived from ticks so replays are deterministic
+	extern Uint32 now();
+
+	// ms to simulated ticks, rounded up
+	extern Uint32 msToTicks(const int &ms);
+
 	// SDL rect wrapper
 	extern SDL_Rect makeRect(const int &x, const int &y, const int &w, const int &h);
 
-	// SDL_RenderCopy wrapper
-	extern bool render(const std::string texture, const SDL_Rect* rect);
+	// queue texture for drawing on the render thread, loading it if not resident;
+	// src picks a region of the texture, nullptr for all of it
+	extern bool render(cachedTexture *texture, const SDL_Rect* rect, const int &layer = layer::BACKGROUND, const SDL_Rect *src = nullptr);
 
 	// init SDL subsystems, windows etc.
-	extern bool init(SDL_Window *&window, SDL_Surface *&windowSurface);
+	// backendName "sdl" falls back to "cpu" if no SDL renderer can be created
+	extern bool init(SDL_Window *&window, SDL_Surface *&windowSurface, const std::string &backendName = "sdl");
 
 	// load image and optimize
 	extern SDL_Surface *loadImage(char fileName[]);
 
-	// SDL image wrapper
-	extern SDL_Texture *loadTexture(const char filename[]);
-
 	// free memory and quit SDL subsytems
 	extern bool close();
 
@@ -0,0 +1,280 @@
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "global.h"
+#include "logger.h"
+#include "textureCache.h"
+#include "hud.h"
+
+namespace hud {
+
+static const int GLYPH_W = 5;
+static const int GLYPH_H = 7;
+static const int SCALE = 2; // atlas pixels per font pixel
+
+// atlas cell, glyph plus a one font pixel gap for spacing and shadow
+static const int CELL_W = (GLYPH_W + 1) * SCALE;
+static const int CELL_H = (GLYPH_H + 1) * SCALE;
+
+static const int PAD = 4; // panel border
+static const int FIELD_CHARS = 14; // longer text is cut
+static const int X = 8; // panel position on screen
+static const int Y = 8;
+
+static const Uint32 GLYPH_COLOR = 0xFFFFFFFF;
+static const Uint32 SHADOW_COLOR = 0xFF202020;
+static const Uint32 PANEL_COLOR = 0x60000000; // translucent black, ARGB
+
+// one byte per row, bit 4 is the leftmost column
+struct glyph {
+	char c;
+	Uint8 rows[GLYPH_H];
+};
+
+static const glyph FONT[] = {
+	{'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+	{'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+	{'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+	{'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+	{'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+	{'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+	{'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+	{'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+	{'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+	{'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+	{'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},
+	{'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+	{'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+	{'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+	{'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+	{'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+	{'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+	{'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+	{'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+	{'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+	{'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+	{'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+	{'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+	{'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+	{'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+	{'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+	{'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+	{'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+	{'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+	{'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+	{'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+	{'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+	{'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+	{'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+	{'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+	{'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+	{':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+	{'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+	{'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+	{'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}}
+};
+
+static const int GLYPHS = sizeof(FONT) / sizeof(FONT[0]);
+
+static const char *LABELS[FIELD_TOTAL] = {"KILLS", "DEATHS", "GRAZES", "SHOTS", "WAVE", "TIME"};
+
+// a field's text as atlas cells, kept until its value changes
+struct field {
+	int value = -1;
+	int total = -1;
+	bool dirty = true;
+	std::vector<int> cells; // atlas cell per character, -1 for space
+};
+
+static field fields[FIELD_TOTAL];
+
+static int cellOf[128]; // atlas cell for each ASCII char, -1 if none
+static SDL_Surface *atlas = nullptr;
+static SDL_Surface *panel = nullptr; // HUD pixels, redrawn per dirty field
+static cachedTexture *texture = nullptr;
+static SDL_Rect onScreen;
+
+static int layouts = 0;
+static int uploads = 0;
+static size_t uploadedBytes = 0;
+
+// set a SCALE sized block of the atlas
+static void plot(Uint32 *pixels, const int &pitch, const int &x, const int &y, const Uint32 &color)
+{
+	for (int dy = 0; dy < SCALE; dy++)
+		for (int dx = 0; dx < SCALE; dx++)
+			pixels[(y * SCALE + dy) * pitch + x * SCALE + dx] = color;
+}
+
+// unpack font bits into one row of cells, shadow first so the glyph covers it
+static bool buildAtlas()
+{
+	atlas = SDL_CreateRGBSurfaceWithFormat(0, GLYPHS * CELL_W, CELL_H, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (atlas == nullptr)
+	{
+		LOG_ERROR("Could not create glyph atlas: ", SDL_GetError());
+		return false;
+	}
+
+	for (int c = 0; c < 128; c++)
+		cellOf[c] = -1;
+
+	SDL_FillRect(atlas, nullptr, 0);
+	SDL_LockSurface(atlas);
+
+	Uint32 *pixels = (Uint32 *)atlas->pixels;
+	int pitch = atlas->pitch / 4;
+
+	for (int g = 0; g < GLYPHS; g++)
+	{
+		cellOf[(int)FONT[g].c] = g;
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			int offset = pass == 0 ? 1 : 0;
+
+			for (int y = 0; y < GLYPH_H; y++)
+				for (int x = 0; x < GLYPH_W; x++)
+					if (FONT[g].rows[y] & (0x10 >> x))
+						plot(pixels, pitch, g * (GLYPH_W + 1) + x + offset, y + offset, pass == 0 ? SHADOW_COLOR : GLYPH_COLOR);
+		}
+	}
+
+	SDL_UnlockSurface(atlas);
+	SDL_SetSurfaceBlendMode(atlas, SDL_BLENDMODE_BLEND);
+	return true;
+}
+
+static SDL_Rect fieldRect(const int &f)
+{
+	return global::makeRect(PAD, PAD + f * CELL_H, FIELD_CHARS * CELL_W, CELL_H);
+}
+
+// copy of part of the panel, for handing to the render thread
+static SDL_Surface *copyPanel(const SDL_Rect &area)
+{
+	SDL_Surface *copy = SDL_CreateRGBSurfaceWithFormat(0, area.w, area.h, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (copy)
+	{
+		SDL_Rect src = area;
+		SDL_BlitSurface(panel, &src, copy, nullptr);
+	}
+	return copy;
+}
+
+bool start()
+{
+	if (!buildAtlas())
+		return false;
+
+	panel = SDL_CreateRGBSurfaceWithFormat(0, PAD * 2 + FIELD_CHARS * CELL_W, PAD * 2 + FIELD_TOTAL * CELL_H, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (panel == nullptr)
+	{
+		LOG_ERROR("Could not create HUD surface: ", SDL_GetError());
+		return false;
+	}
+
+	// panel is only copied from, never blended onto anything on this side
+	SDL_SetSurfaceBlendMode(panel, SDL_BLENDMODE_NONE);
+	SDL_FillRect(panel, nullptr, PANEL_COLOR);
+
+	SDL_Surface *pixels = copyPanel(global::makeRect(0, 0, panel->w, panel->h));
+	if (pixels == nullptr)
+	{
+		LOG_ERROR("Could not copy HUD surface: ", SDL_GetError());
+		return false;
+	}
+
+	texture = textureCache::create("hud", pixels);
+	onScreen = global::makeRect(X, Y, panel->w, panel->h);
+	return true;
+}
+
+void set(const int &f, const int &value, const int &total)
+{
+	field &fd = fields[f];
+	if (fd.value == value && fd.total == total && !fd.cells.empty())
+		return;
+
+	fd.value = value;
+	fd.total = total;
+
+	std::string text = std::string(LABELS[f]) + " ";
+	if (f == TIME)
+	{
+		std::string seconds = std::to_string(value % 60);
+		text += std::to_string(value / 60) + ":" + (seconds.size() < 2 ? "0" : "") + seconds;
+	}
+	else
+	{
+		text += std::to_string(value);
+		if (total > 0)
+			text += "/" + std::to_string(total);
+	}
+
+	fd.cells.clear();
+	for (size_t i = 0; i < text.size() && i < (size_t)FIELD_CHARS; i++)
+		fd.cells.push_back((unsigned char)text[i] < 128 ? cellOf[(int)text[i]] : -1);
+
+	fd.dirty = true;
+	layouts++;
+}
+
+void submit()
+{
+	if (texture == nullptr || global::resimulating || global::headless)
+		return;
+
+	for (int f = 0; f < FIELD_TOTAL; f++)
+	{
+		field &fd = fields[f];
+		if (!fd.dirty) continue;
+
+		SDL_Rect area = fieldRect(f);
+		SDL_FillRect(panel, &area, PANEL_COLOR);
+
+		for (size_t i = 0; i < fd.cells.size(); i++)
+		{
+			if (fd.cells[i] < 0) continue;
+
+			SDL_Rect src = global::makeRect(fd.cells[i] * CELL_W, 0, CELL_W, CELL_H);
+			SDL_Rect dst = global::makeRect(area.x + i * CELL_W, area.y, CELL_W, CELL_H);
+			SDL_BlitSurface(atlas, &src, panel, &dst);
+		}
+
+		SDL_Surface *pixels = copyPanel(area);
+		if (pixels == nullptr)
+		{
+			LOG_WARN_RATE(1, "Could not copy HUD field: ", SDL_GetError());
+			continue;
+		}
+
+		textureCache::update(texture, area, pixels);
+		fd.dirty = false;
+
+		uploads++;
+		uploadedBytes += area.w * area.h * 4;
+	}
+
+	global::render(texture, &onScreen, layer::HUD);
+}
+
+void stop()
+{
+	if (atlas)
+		SDL_FreeSurface(atlas);
+	if (panel)
+		SDL_FreeSurface(panel);
+	atlas = panel = nullptr;
+
+	// texture belongs to the cache until it is cleared
+	texture = nullptr;
+}
+
+void report()
+{
+	LOG_INFO("HUD: ", layouts, " layouts, ", uploads, " field uploads, ", uploadedBytes / 1024, " KB uploaded");
+}
+
+} // end namespace
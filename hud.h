@@ -0,0 +1,36 @@
+#pragma once
+
+// in-game HUD
+// ===========
+// Text is drawn from a 5x7 bitmap font built into a glyph atlas at start,
+// so nothing is rasterized at runtime. The HUD lives in one cached texture:
+// a field is laid out again only when its value changes, and only that
+// field's region is redrawn and uploaded. Each frame draws the texture once.
+namespace hud {
+
+	enum Fields
+	{
+		KILLS,
+		DEATHS,
+		GRAZES,
+		SHOTS,
+		WAVE,
+		TIME, // seconds, shown as m:ss
+		FIELD_TOTAL
+	};
+
+	// build atlas and HUD texture, before the render thread starts
+	extern bool start();
+
+	// value shown in field, as value/total if total > 0
+	extern void set(const int &field, const int &value, const int &total = 0);
+
+	// upload changed fields and draw the HUD, once per shown tick
+	extern void submit();
+
+	extern void stop();
+
+	// layouts and bytes uploaded
+	extern void report();
+
+} // end namespace
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "logger.h"
+#include "inputLatency.h"
+
+namespace inputLatency {
+
+// latency samples kept, later ones are dropped
+static const size_t MAX_SAMPLES = 1 << 16;
+
+static std::atomic<Uint64> pending(0); // earliest event not yet latched
+static std::atomic<Uint64> lastPresented(0);
+static Uint64 inFlight = 0; // latched, not yet presented (game loop only)
+
+static Uint64 lastReported = 0; // render thread only
+static std::vector<double> samples;
+
+static int watchKeys(void *, SDL_Event *event)
+{
+	if ((event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) && !event->key.repeat)
+	{
+		Uint64 expected = 0;
+		pending.compare_exchange_strong(expected, SDL_GetPerformanceCounter());
+	}
+
+	return 1;
+}
+
+void start()
+{
+	samples.reserve(MAX_SAMPLES);
+	SDL_AddEventWatch(watchKeys, nullptr);
+}
+
+void stop()
+{
+	SDL_DelEventWatch(watchKeys, nullptr);
+}
+
+Uint64 latch()
+{
+	if (inFlight != 0 && lastPresented.load(std::memory_order_acquire) >= inFlight)
+		inFlight = 0;
+
+	// newer input collapses into the one already in flight
+	Uint64 stamp = pending.exchange(0);
+	if (stamp != 0 && inFlight == 0)
+		inFlight = stamp;
+
+	return inFlight;
+}
+
+void discard()
+{
+	pending = 0;
+	inFlight = 0;
+}
+
+void presented(const Uint64 &stamp)
+{
+	if (stamp == 0 || stamp <= lastReported)
+		return;
+
+	lastReported = stamp;
+	lastPresented.store(stamp, std::memory_order_release);
+
+	if (samples.size() < MAX_SAMPLES)
+		samples.push_back((SDL_GetPerformanceCounter() - stamp) * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+void report()
+{
+	if (samples.empty())
+	{
+		LOG_INFO("Input latency: no samples");
+		return;
+	}
+
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+
+	LOG_INFO("Input latency: ", sorted.size(), " samples, p50 ", sorted[sorted.size() / 2],
+		" ms, p99 ", sorted[sorted.size() * 99 / 100], " ms, max ", sorted.back(), " ms");
+}
+
+} // end namespace
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// input-to-present latency measurement
+// ====================================
+// Key events are timestamped as SDL pumps them. The game loop latches the
+// earliest unpresented timestamp into each draw list until a present that
+// reflects it is reported by the render thread.
+namespace inputLatency {
+
+	// start timestamping key events
+	extern void start();
+	extern void stop();
+
+	// game loop, after reading keyboard state: earliest input stamp the
+	// tick reflects that hasn't been presented yet, 0 if none
+	extern Uint64 latch();
+
+	// game loop: pending input had no effect (player dead, paused)
+	extern void discard();
+
+	// render thread, after presenting a draw list
+	extern void presented(const Uint64 &stamp);
+
+	// log sample count and p50/p99 latency, call after render thread stopped
+	extern void report();
+
+} // end namespace
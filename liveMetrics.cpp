@@ -0,0 +1,183 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "global.h"
+#include "logger.h"
+#include "bulletContainers.h"
+#include "enemyWaves.h"
+#include "bosses.h"
+#include "particles.h"
+#include "gameState.h"
+#include "liveMetrics.h"
+
+namespace liveMetrics {
+
+thread_local Uint64 allocations = 0;
+bool allocationsCounted = false;
+
+static metricsBlock *block = nullptr;
+static std::string blockName;
+
+// frame and work times of recent publishes, in microseconds
+static Uint32 frameUs[FRAME_WINDOW];
+static Uint32 workUs[FRAME_WINDOW];
+static Uint32 sorted[FRAME_WINDOW]; // scratch for percentiles
+static int samples = 0;
+
+static Uint64 frequency = 0;
+static Uint64 lastPublish = 0;
+static Uint64 lastTests = 0;
+static Uint64 lastAllocations = 0;
+
+// value at fraction p of the first n samples
+static Uint32 percentile(const Uint32 *values, const int &n, const double &p)
+{
+	std::copy(values, values + n, sorted);
+	int k = std::min(n - 1, (int)(p * n));
+	std::nth_element(sorted, sorted + k, sorted + n);
+	return sorted[k];
+}
+
+bool start(const std::string &name)
+{
+	blockName = name[0] == '/' ? name : "/" + name;
+
+	int fd = shm_open(blockName.c_str(), O_CREAT | O_RDWR, 0644);
+	if (fd < 0 || ftruncate(fd, sizeof(metricsBlock)) < 0)
+	{
+		if (fd >= 0) close(fd);
+		LOG_ERROR("Could not create shared memory ", blockName);
+		return false;
+	}
+
+	void *data = mmap(nullptr, sizeof(metricsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		shm_unlink(blockName.c_str());
+		LOG_ERROR("Could not map shared memory ", blockName);
+		return false;
+	}
+
+	// a block left by a crashed run is reused, sequence starts even
+	memset(data, 0, sizeof(metricsBlock));
+	block = new (data) metricsBlock();
+	memcpy(block->magic, MAGIC, sizeof(block->magic));
+	block->version = VERSION;
+	block->size = sizeof(metricsBlock);
+	block->pid = getpid();
+	block->wave = -1;
+	block->flags = allocationsCounted ? FLAG_ALLOCATIONS : 0;
+
+	frequency = SDL_GetPerformanceFrequency();
+	lastPublish = 0;
+	samples = 0;
+	lastTests = global::collisionTests;
+	lastAllocations = allocations;
+
+	LOG_INFO("Publishing live metrics to ", blockName);
+	return true;
+}
+
+void stop()
+{
+	if (block == nullptr)
+		return;
+
+	Uint32 seq = block->sequence.load(std::memory_order_relaxed);
+	block->sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	block->state = STATE_ENDED;
+	block->sequence.store(seq + 2, std::memory_order_release);
+
+	// readers that have it mapped still see the last values
+	munmap(block, sizeof(metricsBlock));
+	shm_unlink(blockName.c_str());
+	block = nullptr;
+}
+
+bool enabled()
+{
+	return block != nullptr;
+}
+
+void publish(const int &state, const double &waitedMs)
+{
+	if (block == nullptr)
+		return;
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (lastPublish != 0)
+	{
+		Uint32 frame = (now - lastPublish) * 1000000 / frequency;
+		Uint32 waited = waitedMs * 1000;
+		frameUs[samples % FRAME_WINDOW] = frame;
+		workUs[samples % FRAME_WINDOW] = frame > waited ? frame - waited : 0;
+		samples++;
+	}
+	lastPublish = now;
+
+	int n = std::min(samples, FRAME_WINDOW);
+	Uint32 frameP50 = 0, frameP90 = 0, frameP99 = 0, frameMax = 0, workP50 = 0, workP99 = 0;
+	if (n > 0)
+	{
+		frameP50 = percentile(frameUs, n, 0.50);
+		frameP90 = percentile(frameUs, n, 0.90);
+		frameP99 = percentile(frameUs, n, 0.99);
+		frameMax = *std::max_element(frameUs, frameUs + n);
+		workP50 = percentile(workUs, n, 0.50);
+		workP99 = percentile(workUs, n, 0.99);
+	}
+
+	Uint64 tests = global::collisionTests;
+	Uint64 allocs = allocations;
+
+	// odd while writing
+	Uint32 seq = block->sequence.load(std::memory_order_relaxed);
+	block->sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	block->state = state;
+	block->updates++;
+
+	block->tick = global::ticks;
+	block->wave = gameState::currentWave();
+	block->waves = enemyWaves.size();
+	block->kills = global::kills;
+	block->shotsFired = global::shotsFired;
+	block->distanceTraveled = global::distanceTraveled;
+	block->deaths = gameState::deaths();
+	block->grazes = gameState::grazes();
+
+	block->enemies = currentEnemies.size();
+	block->bosses = currentBosses.size();
+	block->playerBullets = currentPlayerBullets.size();
+	block->enemyBullets = currentEnemyBullets.size();
+	block->particles = particles::count();
+
+	block->collisionTests = tests;
+	block->allocations = allocs;
+	block->collisionTestsLast = tests - lastTests;
+	block->allocationsLast = allocs - lastAllocations;
+
+	block->frameP50 = frameP50;
+	block->frameP90 = frameP90;
+	block->frameP99 = frameP99;
+	block->frameMax = frameMax;
+	block->workP50 = workP50;
+	block->workP99 = workP99;
+
+	block->sequence.store(seq + 2, std::memory_order_release);
+
+	lastTests = tests;
+	lastAllocations = allocs;
+}
+
+} // end namespace
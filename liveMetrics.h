@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include "liveMetricsFormat.h"
+
+// live metrics
+// ============
+// A metricsBlock in POSIX shared memory, for watching a long running game
+// from outside with tools/metricsView. publish() is called once per game
+// loop pass and only writes memory, so the game thread makes no syscalls
+// and takes no locks for it; readers retry until they get a consistent copy.
+namespace liveMetrics {
+
+	// create shared memory object name (e.g. /sdl-game), false on error
+	extern bool start(const std::string &name);
+
+	// mark the block ended, unmap and unlink it
+	extern void stop();
+
+	extern bool enabled();
+
+	// heap allocations by each thread, only counted when allocationCounter.cpp
+	// is linked in (make COUNT_ALLOCATIONS=1), which sets allocationsCounted
+	extern thread_local Uint64 allocations;
+	extern bool allocationsCounted;
+
+	// game thread, once per loop pass; waitedMs is the time the pass spent
+	// waiting for its tick deadline
+	extern void publish(const int &state, const double &waitedMs);
+
+} // end namespace
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// live metrics shared memory layout, shared by the game and tools/metricsView
+// the shared memory object holds one metricsBlock, rewritten every tick
+namespace liveMetrics {
+
+	const char MAGIC[4] = { 'S', 'H', 'L', 'M' };
+	const std::uint16_t VERSION = 1;
+
+	// ticks frame time percentiles are taken over
+	const int FRAME_WINDOW = 256;
+
+	enum States
+	{
+		STATE_RUNNING,
+		STATE_PAUSED,
+		STATE_WAITING, // netplay, held for the peer
+		STATE_ENDED // game exited, block is no longer written
+	};
+
+	enum Flags
+	{
+		FLAG_ALLOCATIONS = 1 // game built to count allocations
+	};
+
+	// Seqlock: the writer makes sequence odd, writes the fields, then makes
+	// it even again. A reader copies the block and keeps the copy only if
+	// sequence was the same even number before and after.
+	struct metricsBlock {
+		char magic[4];
+		std::uint16_t version;
+		std::uint16_t size; // sizeof(metricsBlock)
+		std::uint32_t pid;
+		std::atomic<std::uint32_t> sequence;
+
+		std::uint32_t state;
+		std::uint32_t updates; // publishes, ticks or not
+
+		// simulation
+		std::uint32_t tick;
+		std::int32_t wave; // in play, -1 before start and after end
+		std::int32_t waves;
+		std::int32_t kills;
+		std::int32_t shotsFired;
+		std::int32_t distanceTraveled;
+		std::int32_t deaths;
+		std::int32_t grazes;
+
+		// entities per container
+		std::uint32_t enemies;
+		std::uint32_t bosses;
+		std::uint32_t playerBullets;
+		std::uint32_t enemyBullets;
+		std::uint32_t particles;
+		std::uint32_t flags; // Flags
+
+		// work, totals and during the last publish
+		std::uint64_t collisionTests;
+		std::uint64_t allocations; // game thread heap allocations, 0 unless FLAG_ALLOCATIONS
+		std::uint32_t collisionTestsLast;
+		std::uint32_t allocationsLast;
+
+		// microseconds over the last FRAME_WINDOW publishes; frame is the
+		// time between publishes, work excludes waiting for the tick deadline
+		std::uint32_t frameP50;
+		std::uint32_t frameP90;
+		std::uint32_t frameP99;
+		std::uint32_t frameMax;
+		std::uint32_t workP50;
+		std::uint32_t workP99;
+	};
+
+	static_assert(ATOMIC_INT_LOCK_FREE == 2, "sequence must be lock free to be shared between processes");
+	static_assert(sizeof(metricsBlock) == 128, "metrics block must be packed");
+
+} // end namespace
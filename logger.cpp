@@ -0,0 +1,215 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <SDL2/SDL.h>
+
+#include "logger.h"
+
+namespace logger {
+
+// records per thread ring, power of two
+static const std::uint32_t RING_SLOTS = 1024;
+static const std::uint32_t RING_MASK = RING_SLOTS - 1;
+
+// one ring per logging thread, written only by that thread
+struct threadRing {
+	record slots[RING_SLOTS];
+	std::atomic<std::uint32_t> head;
+	std::atomic<std::uint32_t> tail;
+	std::atomic<std::uint32_t> dropped;
+	threadRing *next;
+};
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+static std::atomic<threadRing *> rings(nullptr); // lock-free list of all rings
+static thread_local threadRing *localRing = nullptr;
+
+static std::atomic<bool> running(false);
+static SDL_Thread *thread = nullptr;
+
+static const char *levelNames[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+std::uint64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+record *beginRecord()
+{
+	// first record from this thread: allocate and publish its ring
+	if (localRing == nullptr)
+	{
+		localRing = new threadRing();
+		localRing->head = 0;
+		localRing->tail = 0;
+		localRing->dropped = 0;
+		localRing->next = rings.load(std::memory_order_relaxed);
+		while (!rings.compare_exchange_weak(localRing->next, localRing, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	std::uint32_t h = localRing->head.load(std::memory_order_relaxed);
+	if (h - localRing->tail.load(std::memory_order_acquire) >= RING_SLOTS)
+	{
+		localRing->dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	return &localRing->slots[h & RING_MASK];
+}
+
+void endRecord()
+{
+	localRing->head.store(localRing->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// format record arguments onto out
+static void format(const record &r, std::string &out)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "[%11.6f] %s ", r.time / 1e9, levelNames[r.level & 3]);
+	out += buf;
+
+	const char *p = r.args;
+	const char *end = r.args + r.length;
+
+	while (p < end)
+	{
+		std::uint8_t tag = *p++;
+		std::int64_t i;
+		std::uint64_t u;
+		double d;
+		std::uint16_t n;
+
+		switch (tag)
+		{
+		case TAG_INT:
+			memcpy(&i, p, 8);
+			p += 8;
+			snprintf(buf, sizeof(buf), "%lld", (long long)i);
+			out += buf;
+			break;
+		case TAG_UINT:
+			memcpy(&u, p, 8);
+			p += 8;
+			snprintf(buf, sizeof(buf), "%llu", (unsigned long long)u);
+			out += buf;
+			break;
+		case TAG_DOUBLE:
+			memcpy(&d, p, 8);
+			p += 8;
+			snprintf(buf, sizeof(buf), "%g", d);
+			out += buf;
+			break;
+		case TAG_POINTER:
+			memcpy(&u, p, 8);
+			p += 8;
+			snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)u);
+			out += buf;
+			break;
+		case TAG_STRING:
+			memcpy(&n, p, 2);
+			out.append(p + 2, n);
+			p += 2 + n;
+			break;
+		case TAG_CHAR:
+			out += *p++;
+			break;
+		case TAG_BOOL:
+			out += *p++ ? "true" : "false";
+			break;
+		default: // corrupt record
+			p = end;
+			break;
+		}
+	}
+
+	if (r.truncated)
+		out += "...";
+
+	if (r.suppressed)
+	{
+		snprintf(buf, sizeof(buf), " (%u similar suppressed)", r.suppressed);
+		out += buf;
+	}
+
+	out += '\n';
+}
+
+// format and write everything queued, returns number of records
+static int drain()
+{
+	static std::string out;
+	int count = 0;
+
+	for (threadRing *ring = rings.load(std::memory_order_acquire); ring != nullptr; ring = ring->next)
+	{
+		std::uint32_t t = ring->tail.load(std::memory_order_relaxed);
+		std::uint32_t h = ring->head.load(std::memory_order_acquire);
+
+		for (; t != h; t++, count++)
+			format(ring->slots[t & RING_MASK], out);
+
+		ring->tail.store(t, std::memory_order_release);
+
+		std::uint32_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped)
+			out += "[logger] " + std::to_string(dropped) + " records dropped, ring full\n";
+	}
+
+	if (!out.empty())
+	{
+		fwrite(out.data(), 1, out.size(), stdout);
+		fflush(stdout);
+		out.clear();
+	}
+
+	return count;
+}
+
+static int loggerLoop(void *)
+{
+	while (running.load(std::memory_order_acquire))
+	{
+		if (drain() == 0)
+			SDL_Delay(10);
+	}
+
+	return 0;
+}
+
+bool start()
+{
+	if (running) return true;
+
+	running = true;
+	thread = SDL_CreateThread(loggerLoop, "logger", nullptr);
+
+	if (thread == nullptr)
+	{
+		running = false;
+		fprintf(stderr, "Could not create logger thread: %s\n", SDL_GetError());
+		return false;
+	}
+
+	// flush queued records on exit() paths too
+	atexit(stop);
+	return true;
+}
+
+void stop()
+{
+	if (thread != nullptr)
+	{
+		running = false;
+		SDL_WaitThread(thread, nullptr);
+		thread = nullptr;
+	}
+
+	drain();
+}
+
+} // end namespace
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// leveled asynchronous logger
+// ===========================
+// LOG_DEBUG/INFO/WARN/ERROR("text ", value, ...) copy their arguments into a
+// per-thread ring; formatting and writing to stdout happen on the logger
+// thread. Levels below LOG_LEVEL compile to nothing. The _RATE variants let
+// at most perSecond records through per call site and report the rest as
+// suppressed. Nothing on the calling thread locks or makes a syscall; if a
+// thread's ring is full the record is dropped and counted.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_AT(level, ...) logger::write(level, 0, __VA_ARGS__)
+
+#define LOG_AT_RATE(level, perSecond, ...) do { \
+	static logger::rateLimit logRateLimit_(perSecond); \
+	std::uint32_t logSuppressed_; \
+	if (logRateLimit_.allow(logSuppressed_)) logger::write(level, logSuppressed_, __VA_ARGS__); \
+} while (false)
+
+#define LOG_DISABLED(...) do { } while (false)
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(logger::DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_RATE(perSecond, ...) LOG_AT_RATE(logger::DEBUG, perSecond, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISABLED()
+#define LOG_DEBUG_RATE(...) LOG_DISABLED()
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(logger::INFO, __VA_ARGS__)
+#define LOG_INFO_RATE(perSecond, ...) LOG_AT_RATE(logger::INFO, perSecond, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISABLED()
+#define LOG_INFO_RATE(...) LOG_DISABLED()
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(logger::WARN, __VA_ARGS__)
+#define LOG_WARN_RATE(perSecond, ...) LOG_AT_RATE(logger::WARN, perSecond, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_DISABLED()
+#define LOG_WARN_RATE(...) LOG_DISABLED()
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(logger::ERROR, __VA_ARGS__)
+#define LOG_ERROR_RATE(perSecond, ...) LOG_AT_RATE(logger::ERROR, perSecond, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_DISABLED()
+#define LOG_ERROR_RATE(...) LOG_DISABLED()
+#endif
+
+namespace logger {
+
+	enum Levels
+	{
+		DEBUG,
+		INFO,
+		WARN,
+		ERROR
+	};
+
+	// argument tags in a record
+	enum Tags
+	{
+		TAG_INT,
+		TAG_UINT,
+		TAG_DOUBLE,
+		TAG_STRING,
+		TAG_CHAR,
+		TAG_BOOL,
+		TAG_POINTER
+	};
+
+	// fixed size record slot, arguments past the end are truncated
+	const int RECORD_SIZE = 256;
+
+	struct record {
+		std::uint64_t time; // ns since logger start
+		std::uint32_t suppressed; // records dropped by rate limit since last one
+		std::uint16_t length; // bytes used in args
+		std::uint8_t level;
+		std::uint8_t truncated;
+		char args[RECORD_SIZE - 16];
+	};
+
+	// start logger thread, flushes on stop() or exit
+	extern bool start();
+	extern void stop();
+
+	// ns since logger start, from the vDSO clock
+	extern std::uint64_t now();
+
+	// claim next free record in this thread's ring, nullptr if full
+	extern record *beginRecord();
+	extern void endRecord();
+
+	// per call site rate limit
+	class rateLimit {
+		public:
+
+		rateLimit(const int &perSecond) : limit(perSecond), windowStart(0), count(0), suppressed(0) {}
+
+		bool allow(std::uint32_t &suppressedOut)
+		{
+			std::uint64_t t = now();
+			std::uint64_t start = windowStart.load(std::memory_order_relaxed);
+
+			if (t - start >= 1000000000ull && windowStart.compare_exchange_strong(start, t))
+				count = 0;
+
+			if (count.fetch_add(1, std::memory_order_relaxed) < limit)
+			{
+				suppressedOut = suppressed.exchange(0, std::memory_order_relaxed);
+				return true;
+			}
+
+			suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		private:
+
+		const int limit;
+		std::atomic<std::uint64_t> windowStart;
+		std::atomic<int> count;
+		std::atomic<std::uint32_t> suppressed;
+	};
+
+	// argument encoding
+	// =================
+	struct encoder {
+		record *r;
+
+		bool reserve(const int &bytes)
+		{
+			if (r->length + bytes > (int)sizeof(r->args))
+			{
+				r->truncated = 1;
+				return false;
+			}
+			return true;
+		}
+
+		void put(const std::uint8_t &tag, const void *data, const int &size)
+		{
+			if (!reserve(1 + size)) return;
+			r->args[r->length] = tag;
+			memcpy(r->args + r->length + 1, data, size);
+			r->length += 1 + size;
+		}
+
+		void putString(const char *s, size_t size)
+		{
+			if (!reserve(3)) return;
+			if (r->length + 3 + size > sizeof(r->args))
+			{
+				size = sizeof(r->args) - r->length - 3;
+				r->truncated = 1;
+			}
+
+			std::uint16_t n = size;
+			r->args[r->length] = TAG_STRING;
+			memcpy(r->args + r->length + 1, &n, 2);
+			memcpy(r->args + r->length + 3, s, n);
+			r->length += 3 + n;
+		}
+	};
+
+	inline void encode(encoder &e, const char *s) { e.putString(s ? s : "(null)", s ? strlen(s) : 6); }
+	inline void encode(encoder &e, const std::string &s) { e.putString(s.data(), s.size()); }
+	inline void encode(encoder &e, const char &c) { e.put(TAG_CHAR, &c, 1); }
+	inline void encode(encoder &e, const bool &b) { std::uint8_t v = b; e.put(TAG_BOOL, &v, 1); }
+	inline void encode(encoder &e, const float &f) { double v = f; e.put(TAG_DOUBLE, &v, 8); }
+	inline void encode(encoder &e, const double &d) { e.put(TAG_DOUBLE, &d, 8); }
+	inline void encode(encoder &e, const void *p) { std::uint64_t v = (std::uintptr_t)p; e.put(TAG_POINTER, &v, 8); }
+
+	template <typename T>
+	inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type encode(encoder &e, const T &i)
+	{
+		std::int64_t v = i;
+		e.put(TAG_INT, &v, 8);
+	}
+
+	template <typename T>
+	inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type encode(encoder &e, const T &i)
+	{
+		std::uint64_t v = i;
+		e.put(TAG_UINT, &v, 8);
+	}
+
+	template <typename T>
+	inline typename std::enable_if<std::is_enum<T>::value>::type encode(encoder &e, const T &i)
+	{
+		std::int64_t v = i;
+		e.put(TAG_INT, &v, 8);
+	}
+
+	inline void encodeAll(encoder &) {}
+
+	template <typename T, typename... Rest>
+	inline void encodeAll(encoder &e, const T &value, const Rest &... rest)
+	{
+		encode(e, value);
+		encodeAll(e, rest...);
+	}
+
+	// copy arguments into a record, formatted later on logger thread
+	template <typename... Args>
+	inline void write(const int &level, const std::uint32_t &suppressed, const Args &... args)
+	{
+		record *r = beginRecord();
+		if (r == nullptr) return;
+
+		r->time = now();
+		r->suppressed = suppressed;
+		r->length = 0;
+		r->level = level;
+		r->truncated = 0;
+
+		encoder e = { r };
+		encodeAll(e, args...);
+
+		endRecord();
+	}
+
+} // end namespace
@@ -4,9 +4,13 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #undef main
 
-#include "debug.h"
+#include "logger.h"
 #include "global.h"
 #include "bulletContainers.h"
 #include "baseObjects.h"
@@ -14,45 +18,186 @@
 #include "movement.h"
 #include "gameObj.h"
 #include "configFromFile.h"
+#include "renderThread.h"
+#include "renderBackend.h"
+#include "telemetry.h"
+#include "framePacer.h"
+#include "inputLatency.h"
+#include "gameState.h"
+#include "netTransport.h"
+#include "rollback.h"
+#include "particles.h"
+#include "frameCapture.h"
+#include "textureCache.h"
+#include "assetPack.h"
+#include "liveMetrics.h"
+#include "powerScheduler.h"
+#include "hud.h"
+
+// reference textures of a wave and the one after it, so each wave is loaded before it starts
+static void holdWaveTextures(const int &wave, const bool &hold)
+{
+	for (int w = wave; w <= wave + 1; w++)
+	{
+		for (auto &path : waveTextures(w))
+		{
+			if (hold)
+				textureCache::acquire(path);
+			else
+				textureCache::release(path);
+		}
+	}
+}
 
-#include "getPlayerInput.h"
-#include "renderEnemies.h"
-#include "renderBullets.h"
+// whole of text as an int, false on anything else
+static bool parseInt(const char *text, int &value)
+{
+	char *end = nullptr;
+	errno = 0;
+	long parsed = strtol(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX)
+		return false;
+
+	value = parsed;
+	return true;
+}
 
 int main(int argc, char* argv[])
 {
+	logger::start();
+
+	// command line options
+	std::string telemetryFile;
+	std::string metricsName; // shared memory object, e.g. /sdl-game
+	std::string captureFile; // .y4m stream or PNG prefix
+	int captureWorkers = 2;
+	std::string backendName = "sdl";
+	bool headless = false;
+	int benchTicks = 0; // run this many ticks, report render cost and quit
+	std::string packFile = "assets/assets.pack"; // empty to decode every image
+
+	// netplay, player 1 or 2 over local ports
+	int netplayer = 0;
+	int localPort = 0;
+	int peerPort = 0;
+	int latency = 0;
+	int jitter = 0;
+
+	const char *usage = "usage: sdl-game [--telemetry file] [--metrics name] [--capture file] [--capture-workers n]"
+		" [--renderer name] [--headless] [--bench ticks] [--netplay 1|2] [--port n] [--peer n]"
+		" [--latency ms] [--jitter ms] [--pack file] [--no-pack]";
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool valid = true;
+
+		if (arg == "--telemetry" && i + 1 < argc)
+			telemetryFile = argv[++i];
+		else if (arg == "--metrics" && i + 1 < argc)
+			metricsName = argv[++i];
+		else if (arg == "--capture" && i + 1 < argc)
+			captureFile = argv[++i];
+		else if (arg == "--capture-workers" && i + 1 < argc)
+			valid = parseInt(argv[++i], captureWorkers);
+		else if (arg == "--renderer" && i + 1 < argc)
+			backendName = argv[++i];
+		else if (arg == "--headless")
+			headless = true;
+		else if (arg == "--bench" && i + 1 < argc)
+			valid = parseInt(argv[++i], benchTicks);
+		else if (arg == "--netplay" && i + 1 < argc)
+			valid = parseInt(argv[++i], netplayer) && (netplayer == 1 || netplayer == 2);
+		else if (arg == "--port" && i + 1 < argc)
+			valid = parseInt(argv[++i], localPort);
+		else if (arg == "--peer" && i + 1 < argc)
+			valid = parseInt(argv[++i], peerPort);
+		else if (arg == "--latency" && i + 1 < argc)
+			valid = parseInt(argv[++i], latency);
+		else if (arg == "--jitter" && i + 1 < argc)
+			valid = parseInt(argv[++i], jitter);
+		else if (arg == "--pack" && i + 1 < argc)
+			packFile = argv[++i];
+		else if (arg == "--no-pack")
+			packFile.clear();
+
+		if (!valid)
+		{
+			LOG_ERROR("Bad value for ", arg, ": ", argv[i]);
+			LOG_ERROR(usage);
+			return -1;
+		}
+	}
+
+	// player 1 listens on 7000, player 2 on 7001
+	if (localPort == 0) localPort = netplayer == 2 ? 7001 : 7000;
+	if (peerPort == 0) peerPort = netplayer == 2 ? 7000 : 7001;
+
+	// no display needed
+	if (headless)
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
 	// init sdl
-	if (!global::init(global::window, global::windowSurface))
+	if (!global::init(global::window, global::windowSurface, backendName))
 	{
-		DEBUG_MSG("Init failed");
+		LOG_ERROR("Init failed");
 		return -1;
 	}
 
 	// hide cursor
 	SDL_ShowCursor(SDL_DISABLE);
 
+	// config and startup textures, compare with --no-pack
+	Uint64 startupBegin = SDL_GetPerformanceCounter();
+
+	// images decoded by asset-pack, anything not in it is loaded from its PNG
+	if (!packFile.empty())
+		assetPack::open(packFile);
+
 	// containers
 	// ==========
 
-	// load textures
-	global::allTextures["player"] = global::loadTexture("assets/player.png");
-	global::allTextures["cloud-bg"] = global::loadTexture("assets/cloud-bg.png");
-	global::allTextures["hitbox"] = global::loadTexture("assets/hitbox.png");
-
-	DEBUG_MSG("Loading Bullets:");
+	LOG_DEBUG("Loading Bullets:");
 	// load bullets from file
-	bulletsFromFile("config/bullets.conf", baseBullets);	
-	DEBUG_MSG("\tSuccess");
+	bulletsFromFile("config/bullets.conf");
+	LOG_DEBUG("\tSuccess");
 
-	DEBUG_MSG("Loading Enemies:");
+	LOG_DEBUG("Loading Enemies:");
 	// enemies from file
-	enemiesFromFile("config/enemies.conf", baseEnemies);
-	DEBUG_MSG("\tSuccess");
+	enemiesFromFile("config/enemies.conf");
+	LOG_DEBUG("\tSuccess");
+
+	LOG_DEBUG("Loading Bosses:");
+	// bosses are built from enemies
+	bossesFromFile("config/bosses.conf");
+	LOG_DEBUG("\tSuccess");
 
-	DEBUG_MSG("Loading Waves:");
+	LOG_DEBUG("Loading Waves:");
 	// enemies from file
-	wavesFromFile("config/waves.conf", enemyWaves);
-	DEBUG_MSG("\tSuccess");
+	wavesFromFile("config/waves.pre", enemyWaves);
+	LOG_DEBUG("\tSuccess");
+
+	gameState::definePlayers();
+	int background = prototypes::define(archetype("background", "assets/cloud-bg.png", 5, 800, 600));
+
+	// textures used for the whole game, and the first waves; later waves load one wave ahead
+	for (const char *name : {"player", "hitbox", "red", "background"})
+		textureCache::acquire(prototypes::get(prototypes::find(name)).texture->path);
+
+	int heldWave = 0;
+	holdWaveTextures(heldWave, true);
+
+	textureCache::stats startup = textureCache::counters();
+	LOG_INFO("Startup: ", (SDL_GetPerformanceCounter() - startupBegin) * 1000.0 / SDL_GetPerformanceFrequency(), " ms, ",
+		startup.loads, " textures (", startup.packLoads, " packed) in ", startup.loadMs, " ms");
+
+	// render scaling settings
+	resolutionScaler::settings video;
+	videoFromFile("config/video.conf", video);
+
+	// benchmark at full resolution
+	if (benchTicks > 0)
+		video.minScale = video.maxScale = 100;
 
 
 /*
@@ -80,15 +225,8 @@ std::vector<std::vector<gameObj*>> enemyWaves = {
 */
 
 
-	// make player 
-	// ===========
-
-	// construct player
-	gameObj player = gameObj("player", 8, 50, 85, global::SCREEN_WIDTH / 2 - 10 / 2, global::SCREEN_HEIGHT / 2 - 100 / 2, "red", 100);
-	gameObj hitbox = gameObj("hitbox", player.velocity, 10, 10);
-
 	// set background
-	gameObj bg = gameObj("cloud-bg", 5, 800, 600);
+	gameObj bg = gameObj(background);
 	SDL_Rect bgRect = bg.rect; // rect for 2nd bg render
 	bgRect.y = -bg.rect.h;
 
@@ -96,6 +234,42 @@ std::vector<std::vector<gameObj*>> enemyWaves = {
 	bool quit = false;
 	bool paused = false;
 
+	// make players
+	// ============
+	gameState::init(netplayer > 0 ? 2 : 1);
+
+	// netplay session, this peer controls player netplayer
+	rollbackSession *session = nullptr;
+	if (netplayer > 0)
+	{
+		if (!netTransport::open(localPort, peerPort, latency, jitter))
+		{
+			global::close();
+			return -1;
+		}
+		session = new rollbackSession(netplayer - 1);
+	}
+
+	// capture before render thread starts presenting
+	if (captureFile != "" && !frameCapture::start(captureFile, captureWorkers))
+	{
+		global::close();
+		return -1;
+	}
+
+	// glyph atlas and HUD texture, uploaded once the render thread runs
+	if (!hud::start())
+	{
+		global::close();
+		return -1;
+	}
+
+	// hand renderer over to render thread
+	if (!renderThread::start(video))
+	{
+		global::close();
+		return -1;
+	}
 
 
 	// event handler
@@ -104,31 +278,34 @@ std::vector<std::vector<gameObj*>> enemyWaves = {
 	// realtime keystate
 	const Uint8* keyState = SDL_GetKeyboardState(nullptr);
 
-	// player life state bools
-	bool playerIsDead = false;
-	bool playerIsInvulnerable = false;
-	
-	// player life timeouts
-	int playerDeathTimeout;
-	int playerInvulnerableTimeout;
-
 	// timekeeping
-	int startDelay = SDL_GetTicks() + 1000;
-	int startingTime = SDL_GetTicks();
+	Uint32 startingTime = SDL_GetTicks();
 
 	// scorekeeping
-	int deaths = 0;
-	int numEnemies = 0;
-		for(auto &w : enemyWaves) numEnemies += w.size();
+	int numEnemies = gameState::numEnemies();
 	int numWaves = enemyWaves.size();
 
+	if (telemetryFile != "")
+		telemetry::start(telemetryFile);
+
+	if (metricsName != "")
+		liveMetrics::start(metricsName);
+
+	// 60 ticks per second
+	framePacer pacer(1000.0 / global::TICK_RATE);
+	inputLatency::start();
+
 	// game loop
 	//===========
 	while (!quit)
 	{
+		// nothing ticks while paused or in a background state with rate 0,
+		// so sleep in the event queue instead of polling it
+		bool idle = powerScheduler::idle();
+		Uint64 idleStart = SDL_GetPerformanceCounter();
 
 		// event polling loop
-		while (SDL_PollEvent(&event))
+		for (bool got = idle ? SDL_WaitEventTimeout(&event, powerScheduler::IDLE_WAKE_MS) : SDL_PollEvent(&event); got; got = SDL_PollEvent(&event))
 		{
 			// window close event
 			if (event.type == SDL_QUIT)
@@ -137,13 +314,21 @@ std::vector<std::vector<gameObj*>> enemyWaves = {
 				break;
 			}
 
+			// focus, visibility, and a lost frame to put back on screen
+			if (event.type == SDL_WINDOWEVENT)
+			{
+				powerScheduler::handle(event);
+				if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+					renderThread::redraw();
+			}
+
 			// keyboard events
 			if (event.type == SDL_KEYDOWN)
 			{
 				switch (event.key.keysym.sym)
 				{
-				case SDLK_ESCAPE: // pause
-					paused = paused ? false : true;
+				case SDLK_ESCAPE: // pause, peer keeps running in netplay
+					paused = session ? false : !paused;
 					break;
 
 				case SDLK_RETURN: // quit
@@ -154,15 +339,48 @@ std::vector<std::vector<gameObj*>> enemyWaves = {
 		} // end poll events
 
 
-		// skip scene updating when paused
-		if (paused) goto renderPresent;
+		// background tick rates, or none
+		if (powerScheduler::update(paused, session != nullptr))
+			pacer.setPeriod(powerScheduler::tickMs());
+
+		// skip scene updating when idle, render thread keeps last frame on screen
+		if (powerScheduler::idle())
+		{
+			inputLatency::discard();
+			liveMetrics::publish(liveMetrics::STATE_PAUSED, idle ? (SDL_GetPerformanceCounter() - idleStart) * 1000.0 / SDL_GetPerformanceFrequency() : 0);
+			continue;
+		}
+
+		// netplay, catch up with remote inputs
+		if (session)
+		{
+			session->poll();
+
+			if (session->disconnected())
+			{
+				LOG_WARN("Peer disconnected");
+				break;
+			}
+
+			// too far ahead of peer, hold this tick
+			if (session->stalled())
+			{
+				LOG_INFO_RATE(1, "Waiting for peer");
+				inputLatency::discard();
+				pacer.wait();
+				liveMetrics::publish(liveMetrics::STATE_WAITING, pacer.waitedMs());
+				continue;
+			}
+
+			session->beginTick();
+		}
+
+		if (benchTicks > 0 && global::ticks >= (Uint32)benchTicks)
+			break;
 
 		// update scene
 		// ============
 
-		// clear window
-		SDL_RenderClear(global::renderer);
-
 		// background scrolling
 		if (bg.rect.y > global::SCREEN_HEIGHT - 1) // reset bg positions
 		{
@@ -171,114 +389,127 @@ std::vector<std::vector<gameObj*>> enemyWaves = {
 		}
 		else // scroll bg's
 		{
-			bg.rect.y += bg.velocity;
-			bgRect.y += bg.velocity;
+			bg.rect.y += bg.proto().velocity;
+			bgRect.y += bg.proto().velocity;
 		}
 
 		// render bgs
-		global::render(bg.currentTexture, &bg.rect);
-		global::render(bg.currentTexture, &bgRect);
-
-		// player alive routine (render player, enemy bullets)
-		// ===================================================
-		if (!playerIsDead)
-		{
-			playerDeathTimeout = SDL_GetTicks() + 500; // keep updating death timeout
-
-			// get input
-			getPlayerInput(player, keyState);
+		global::render(bg.proto().texture, &bg.rect, layer::BACKGROUND);
+		global::render(bg.proto().texture, &bgRect, layer::BACKGROUND);
 
-			// update hitbox position to middle of player
-			hitbox.rect.x = (player.rect.x + player.rect.w / 2 - 4);
-			hitbox.rect.y = (player.rect.y + player.rect.h / 2 - 4);
+		// bullets, respawns and enemies (player step comes last)
+		if (!gameState::stepWorld())
+			break; // all waves completed, game ends
 
-			// render player
-			if (playerIsInvulnerable) // check invulnerability after respawn
-				movement::blink(&player);
-			else
-			{
-				global::render(player.currentTexture, &player.rect);
-				global::render(hitbox.currentTexture, &hitbox.rect);
-			}
-
-			// render bullets
-			// =========================
-			renderBullets(currentPlayerBullets);
-			renderBullets(currentEnemyBullets);
-
-			// check for enemy bullet collision (hitbox is player middle)
-			for (auto &bullet : currentEnemyBullets)
-			{
-				if (!playerIsInvulnerable && SDL_HasIntersection(&hitbox.rect, &bullet.rect))
-				{
-					playerIsDead = true;
-					deaths++;
-					break;
-				}
-			}
-		}
-		else
+		// wave changed, prefetch the next one and let older textures go
+		if (gameState::wavesCleared() != heldWave)
 		{
-			// dead, delay between respawn
-			// ===========================
+			holdWaveTextures(gameState::wavesCleared(), true);
+			holdWaveTextures(heldWave, false);
+			heldWave = gameState::wavesCleared();
+		}
 
-			playerInvulnerableTimeout = SDL_GetTicks() + 1000; // update invulnerability timeout
+		// wait for tick deadline, then latch input as late as possible
+		pacer.wait();
 
-			currentEnemyBullets.clear(); // remove bullets
+		// player step
+		// ===========
+		SDL_PumpEvents();
 
-			// player comes back
-			if (SDL_TICKS_PASSED(SDL_GetTicks(), playerDeathTimeout))
-			{
-				playerIsDead = false;
-				playerIsInvulnerable = true;
-			}
-		}
+		// no reaction on screen while dead or hidden
+		if (powerScheduler::visible() && !gameState::players[netplayer > 0 ? netplayer - 1 : 0].isDead)
+			renderThread::currentList().inputStamp = inputLatency::latch();
+		else
+			inputLatency::discard();
 
-		// spawn protection
-		if (playerIsInvulnerable && SDL_TICKS_PASSED(SDL_GetTicks(), playerInvulnerableTimeout))
-			playerIsInvulnerable = false;
+		playerInput input = readPlayerInput(keyState);
 
-		// render enemies
-		if(SDL_GetTicks() > startDelay) // starting game delay
+		if (session)
+			session->endTick(input);
+		else
+			gameState::stepPlayers(&input);
+
+		// effects, visual only so they run once per shown tick
+		particles::update();
+		particles::submit();
+
+		// HUD, fields only redraw when their value changes
+		hud::set(hud::KILLS, global::kills, numEnemies);
+		hud::set(hud::DEATHS, gameState::deaths());
+		hud::set(hud::GRAZES, gameState::grazes());
+		hud::set(hud::SHOTS, global::shotsFired);
+		hud::set(hud::WAVE, std::min(gameState::wavesCleared() + 1, numWaves), numWaves);
+		hud::set(hud::TIME, global::now() / 1000);
+		hud::submit();
+
+		// hand tick's draw list to render thread, unless nobody can see it
+		// frame numbers count submitted lists, eviction keeps the last one's textures
+		if (powerScheduler::visible())
 		{
-			if(enemyWaves.size() > 0)	
-			{
-				if(enemyWaves.front().size() > 0)
-					renderEnemies(enemyWaves.front(), currentPlayerBullets);
-				else
-					enemyWaves.erase(enemyWaves.begin());
-			}
-			else
-				break; // all waves completed, game ends
+			renderThread::submit();
+			textureCache::endFrame();
 		}
+		else
+			renderThread::discard();
 
-		// render current textures
-		renderPresent:
-
-		SDL_RenderPresent(global::renderer);
-
-		SDL_Delay(16);
+		liveMetrics::publish(liveMetrics::STATE_RUNNING, pacer.waitedMs());
 	}
 
 	//==============
 	// end game loop
 
 	int playTime = (SDL_GetTicks() - startingTime)/1000;
+	int renderScale = renderThread::scale();
+
+	renderThread::stop();
+	frameCapture::stop();
+	frameCapture::report();
+	telemetry::stop();
+	liveMetrics::stop();
+	inputLatency::stop();
+	inputLatency::report();
+	powerScheduler::report();
+	particles::report();
+	hud::stop();
+	hud::report();
+	textureCache::report();
+
+	if (session)
+	{
+		session->report();
+		delete session;
+		netTransport::close();
+	}
+
+	// benchmark report
+	if (benchTicks > 0)
+	{
+		renderThread::stats frames = renderThread::frameTimes();
+		LOG_INFO("Bench ", global::backend->name(), ": ", frames.frames, " frames, ",
+			frames.frames ? frames.totalMs / frames.frames : 0.0, " ms/frame avg, ", frames.worstMs, " ms worst");
+
+		global::close();
+		logger::stop();
+		return 0;
+	}
 
 	std::stringstream gameplayStats;
-	gameplayStats << "Deaths: " << deaths << "\n";
+	gameplayStats << "Deaths: " << gameState::deaths() << "\n";
 	gameplayStats << "Kills: " << global::kills << "/" << numEnemies << "\n";
 	gameplayStats << "Shots: " << global::shotsFired << "\n";
-	gameplayStats << "Waves: " << numWaves - enemyWaves.size() << "/" << numWaves << "\n";
+	gameplayStats << "Waves: " << gameState::wavesCleared() << "/" << numWaves << "\n";
 	gameplayStats << "Traveled: " << global::distanceTraveled << "px\n";
-	gameplayStats << "Time: " << playTime << "s";
+	gameplayStats << "Time: " << playTime << "s\n";
+	gameplayStats << "Render scale: " << renderScale << "% (" << video.minScale << "-" << video.maxScale << "%)";
 
 	SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Stats", gameplayStats.str().c_str(), NULL);
 
 	// close SDL subsystems
 	global::close();
-	DEBUG_MSG("** Gameplay stats **");
-	DEBUG_MSG(gameplayStats.str());
+	LOG_INFO("** Gameplay stats **");
+	LOG_INFO(gameplayStats.str());
+
+	logger::stop();
 
 	return 0;
 }
@@ -2,6 +2,8 @@
 #include "gameObj.h"
 #include "movement.h"
 #include "bulletContainers.h"
+#include "telemetry.h"
+#include "gameState.h"
 
 namespace movement {
 	bool endMovement(const gameObj* g)
@@ -19,38 +21,42 @@ namespace movement {
 
 	bool fire(gameObj* g)
 	{
-		if (SDL_TICKS_PASSED(SDL_GetTicks(), g->timeout))
+		if (g->canFire)
 		{
-			currentEnemyBullets.push_back(g->getBulletCopy());
-			g->resetTimeout();
+			addEnemyBullet(g->getBulletCopy());
+			telemetry::record(telemetry::EVENT_FIRE, g->rect.x, g->rect.y, 1);
+
+			// cooldown
+			g->canFire = false;
+			gameState::timers.add(global::ticks + global::msToTicks(g->proto().duration), gameState::TIMER_ENEMY_FIRE, g->id);
 		}
 		return true;
 	}
 
 	bool up(gameObj *g)
 	{
-		g->rect.y -= g->velocity;
+		g->rect.y -= g->proto().velocity;
 	
 		return true;
 	}
 
 	bool down(gameObj *g)
 	{
-		g->rect.y += g->velocity;
+		g->rect.y += g->proto().velocity;
 	
 		return true;
 	}
 
 	bool left(gameObj *g)
 	{
-		g->rect.x -= g->velocity;
+		g->rect.x -= g->proto().velocity;
 	
 		return true;
 	}
 
 	bool right(gameObj *g)
 	{
-		g->rect.x += g->velocity;
+		g->rect.x += g->proto().velocity;
 	
 		return true;
 	}
@@ -68,8 +74,8 @@ namespace movement {
 
 	bool blink(gameObj* g)
 	{
-		if (SDL_GetTicks() & 1) // render on odd tick (blink)
-			global::render(g->currentTexture, &g->rect);
+		if (global::ticks & 1) // render on odd tick (blink)
+			g->draw(layer::PLAYER);
 
 		return true;
 	}
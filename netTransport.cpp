@@ -0,0 +1,127 @@
+#include <SDL2/SDL.h>
+#include <vector>
+#include <deque>
+#include <random>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "logger.h"
+#include "netTransport.h"
+
+namespace netTransport {
+
+// packet waiting for its emulated delay
+struct delayedPacket {
+	Uint32 due;
+	std::vector<char> data;
+};
+
+static int sock = -1;
+static sockaddr_in remote;
+
+static int latency = 0;
+static int jitter = 0;
+static std::mt19937 rng;
+static std::deque<delayedPacket> outgoing; // sorted by due time
+
+bool open(const int &localPort, const int &remotePort, const int &latencyMs, const int &jitterMs)
+{
+	sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sock < 0)
+	{
+		LOG_ERROR("Socket failed: ", strerror(errno));
+		return false;
+	}
+
+	// never block the game loop
+	fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+	sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_port = htons(localPort);
+	local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (bind(sock, (sockaddr*)&local, sizeof(local)) < 0)
+	{
+		LOG_ERROR("Bind to port ", localPort, " failed: ", strerror(errno));
+		close();
+		return false;
+	}
+
+	memset(&remote, 0, sizeof(remote));
+	remote.sin_family = AF_INET;
+	remote.sin_port = htons(remotePort);
+	remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	latency = latencyMs;
+	jitter = jitterMs;
+	rng.seed(localPort);
+	outgoing.clear();
+
+	LOG_INFO("Netplay on port ", localPort, " to ", remotePort, ", ", latency, "+/-", jitter, " ms");
+	return true;
+}
+
+void close()
+{
+	if (sock >= 0)
+		::close(sock);
+
+	sock = -1;
+	outgoing.clear();
+}
+
+void send(const void *data, const int &size)
+{
+	if (sock < 0) return;
+
+	int delay = latency;
+	if (jitter > 0)
+		delay += std::uniform_int_distribution<int>(-jitter, jitter)(rng);
+
+	delayedPacket packet;
+	packet.due = SDL_GetTicks() + (delay > 0 ? delay : 0);
+	packet.data.assign((const char*)data, (const char*)data + size);
+
+	// keep queue ordered by due time, jitter reorders packets
+	auto it = outgoing.end();
+	while (it != outgoing.begin() && SDL_TICKS_PASSED((it - 1)->due, packet.due + 1))
+		--it;
+	outgoing.insert(it, packet);
+
+	flush();
+}
+
+void flush()
+{
+	Uint32 now = SDL_GetTicks();
+
+	while (!outgoing.empty() && SDL_TICKS_PASSED(now, outgoing.front().due))
+	{
+		std::vector<char> &data = outgoing.front().data;
+
+		// peer not listening yet is not an error, inputs are resent
+		if (sendto(sock, data.data(), data.size(), 0, (sockaddr*)&remote, sizeof(remote)) < 0 && errno != ECONNREFUSED)
+			LOG_WARN_RATE(1, "Send failed: ", strerror(errno));
+
+		outgoing.pop_front();
+	}
+}
+
+int receive(void *data, const int &maxSize)
+{
+	if (sock < 0) return -1;
+
+	flush();
+
+	ssize_t size = recv(sock, data, maxSize, 0);
+	return size < 0 ? -1 : (int)size;
+}
+
+} // end namespace
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// local datagram link
+// ===================
+// UDP between two processes on 127.0.0.1. Outgoing packets are held
+// back by latency +/- jitter to emulate a real connection, so they can
+// arrive late and out of order.
+namespace netTransport {
+
+	// bind localPort, send to remotePort; false on socket errors
+	extern bool open(const int &localPort, const int &remotePort, const int &latencyMs = 0, const int &jitterMs = 0);
+	extern void close();
+
+	// queue packet, goes out on flush() once its delay has passed
+	extern void send(const void *data, const int &size);
+	extern void flush();
+
+	// next received packet size, or -1 when none waiting
+	extern int receive(void *data, const int &maxSize);
+
+} // end namespace
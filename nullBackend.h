@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include "renderBackend.h"
+
+// backend that draws nothing, for simulating without a window
+class nullBackend : public renderBackend {
+	public:
+
+	const char *name() const { return "null"; }
+
+	// keeps size only
+	texture *createTexture(SDL_Surface *surface)
+	{
+		texture *t = new texture();
+		t->width = surface->w;
+		t->height = surface->h;
+		return t;
+	}
+
+	void destroyTexture(texture *t) { delete t; }
+	void updateTexture(texture *, const SDL_Rect &, SDL_Surface *) {}
+
+	bool initTarget(const int &) { return false; }
+	void releaseTarget() {}
+
+	void beginFrame(const int &) {}
+	void draw(const texture *, const SDL_Rect *, const SDL_Rect &) {}
+	void fillRects(const SDL_Rect *, const int &, const SDL_Color &) {}
+	void endFrame(const int &) {}
+	bool readFrame(Uint32 *) { return false; }
+	void present() {}
+};
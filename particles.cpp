@@ -0,0 +1,319 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "global.h"
+#include "logger.h"
+#include "drawList.h"
+#include "renderThread.h"
+#include "particles.h"
+
+namespace particles {
+
+// velocity kept per tick, sparks slow down
+static const float DRAG = 0.92f;
+
+// live particles of one emitter
+struct pool {
+	std::string name;
+	emitter settings;
+
+	// structure of arrays, x/y/vx/vy in px, life in ticks left
+	std::vector<float> x, y, vx, vy, life, size;
+};
+
+static std::vector<pool> pools;
+static int budget = 2048;
+static int live = 0;
+
+// burst directions, sampled instead of calling sin/cos per particle
+static const int DIRECTIONS = 64;
+static float dirX[DIRECTIONS];
+static float dirY[DIRECTIONS];
+
+static Uint32 seed = 0x9E3779B9;
+
+// bursts of ticks netplay may still roll back
+struct heldBurst {
+	int id;
+	float x, y;
+	Uint32 tick;
+};
+
+static bool holding = false;
+static std::vector<heldBurst> held;
+
+// stats
+static int peak = 0;
+static long long merged = 0;
+static long long shed = 0;
+static int frames = 0;
+static double totalMs = 0;
+static double worstMs = 0;
+
+// xorshift, keeps effects out of any gameplay random state
+static inline Uint32 nextRandom()
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static void init()
+{
+	if (!pools.empty()) return;
+
+	for (int i = 0; i < DIRECTIONS; i++)
+	{
+		dirX[i] = std::cos(i * 2 * M_PI / DIRECTIONS);
+		dirY[i] = std::sin(i * 2 * M_PI / DIRECTIONS);
+	}
+
+	pools.resize(BUILTIN_TOTAL);
+
+	pools[PLAYER_DEATH].name = "player";
+	pools[PLAYER_DEATH].settings.color = {255, 80, 60, 255};
+	pools[PLAYER_DEATH].settings.count = 48;
+	pools[PLAYER_DEATH].settings.speed = 5;
+	pools[PLAYER_DEATH].settings.life = 40;
+	pools[PLAYER_DEATH].settings.size = 5;
+
+	pools[BULLET_CANCEL].name = "cancel";
+	pools[BULLET_CANCEL].settings.color = {255, 230, 160, 255};
+	pools[BULLET_CANCEL].settings.count = 4;
+	pools[BULLET_CANCEL].settings.speed = 1.5f;
+	pools[BULLET_CANCEL].settings.life = 20;
+	pools[BULLET_CANCEL].settings.size = 3;
+}
+
+int define(const std::string &name, const emitter &e)
+{
+	init();
+
+	int id = find(name);
+	if (id < 0)
+	{
+		id = pools.size();
+		pools.push_back(pool());
+		pools[id].name = name;
+	}
+
+	pools[id].settings = e;
+	return id;
+}
+
+int find(const std::string &name)
+{
+	init();
+
+	for (size_t i = 0; i < pools.size(); i++)
+		if (pools[i].name == name)
+			return i;
+
+	return -1;
+}
+
+void setBudget(const int &maxParticles)
+{
+	budget = std::max(maxParticles, 0);
+}
+
+static void burst(const int &id, const float &x, const float &y)
+{
+	init();
+
+	if (id < 0 || id >= (int)pools.size())
+		return;
+
+	pool &p = pools[id];
+	const emitter &e = p.settings;
+
+	// over budget: merge the burst into fewer particles of equal total area
+	int wanted = e.count;
+	int count = std::min(wanted, budget - live);
+	if (count <= 0)
+	{
+		shed += wanted;
+		return;
+	}
+
+	merged += wanted - count;
+	float size = e.size * std::sqrt((float)wanted / count);
+
+	for (int i = 0; i < count; i++)
+	{
+		Uint32 r = nextRandom();
+		int dir = r % DIRECTIONS;
+		float speed = e.speed * (0.3f + 0.7f * ((r >> 8) & 0xFF) / 255.0f);
+
+		p.x.push_back(x);
+		p.y.push_back(y);
+		p.vx.push_back(dirX[dir] * speed);
+		p.vy.push_back(dirY[dir] * speed);
+		p.life.push_back(e.life - (int)((r >> 16) % (e.life / 4 + 1))); // stagger fade out
+		p.size.push_back(size);
+	}
+
+	live += count;
+	peak = std::max(peak, live);
+}
+
+void emit(const int &id, const float &x, const float &y)
+{
+	if (global::headless)
+		return;
+
+	if (holding)
+		held.push_back({ id, x, y, global::ticks });
+	else
+		burst(id, x, y);
+}
+
+void hold(const bool &on)
+{
+	holding = on;
+	held.clear();
+}
+
+void confirm(const Uint32 &tick)
+{
+	size_t n = 0;
+	for (; n < held.size() && held[n].tick <= tick; n++)
+		burst(held[n].id, held[n].x, held[n].y);
+
+	held.erase(held.begin(), held.begin() + n);
+}
+
+void rollback(const Uint32 &tick)
+{
+	while (!held.empty() && held.back().tick >= tick)
+		held.pop_back();
+}
+
+// integrate one pool, remove dead particles
+static void updatePool(pool &p)
+{
+	int n = p.x.size();
+	float *x = p.x.data(), *y = p.y.data(), *vx = p.vx.data(), *vy = p.vy.data(), *life = p.life.data();
+
+	int i = 0;
+#ifdef __SSE2__
+	const __m128 drag = _mm_set1_ps(DRAG);
+	const __m128 one = _mm_set1_ps(1);
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(x + i);
+		__m128 py = _mm_loadu_ps(y + i);
+		__m128 pvx = _mm_loadu_ps(vx + i);
+		__m128 pvy = _mm_loadu_ps(vy + i);
+
+		_mm_storeu_ps(x + i, _mm_add_ps(px, pvx));
+		_mm_storeu_ps(y + i, _mm_add_ps(py, pvy));
+		_mm_storeu_ps(vx + i, _mm_mul_ps(pvx, drag));
+		_mm_storeu_ps(vy + i, _mm_mul_ps(pvy, drag));
+		_mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), one));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		x[i] += vx[i];
+		y[i] += vy[i];
+		vx[i] *= DRAG;
+		vy[i] *= DRAG;
+		life[i] -= 1;
+	}
+
+	// swap dead particles with the last live one
+	for (i = 0; i < n; )
+	{
+		if (life[i] > 0)
+		{
+			i++;
+			continue;
+		}
+
+		n--;
+		x[i] = x[n]; y[i] = y[n];
+		vx[i] = vx[n]; vy[i] = vy[n];
+		life[i] = life[n];
+		p.size[i] = p.size[n];
+		live--;
+	}
+
+	p.x.resize(n); p.y.resize(n);
+	p.vx.resize(n); p.vy.resize(n);
+	p.life.resize(n); p.size.resize(n);
+}
+
+void update()
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	for (auto &p : pools)
+		if (!p.x.empty())
+			updatePool(p);
+
+	double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+	frames++;
+	totalMs += ms;
+	worstMs = std::max(worstMs, ms);
+}
+
+void submit()
+{
+	drawList &list = renderThread::currentList();
+
+	for (auto &p : pools)
+	{
+		int n = p.x.size();
+		if (n == 0) continue;
+
+		rectBatch batch;
+		batch.color = p.settings.color;
+		batch.layer = layer::PARTICLE;
+		batch.first = list.rects.size();
+		batch.count = n;
+
+		// shrink with remaining life
+		float fade = 1.0f / p.settings.life;
+		for (int i = 0; i < n; i++)
+		{
+			int s = std::max(1, (int)(p.size[i] * p.life[i] * fade + 0.5f));
+			list.rects.push_back(global::makeRect((int)p.x[i] - s / 2, (int)p.y[i] - s / 2, s, s));
+		}
+
+		list.batches.push_back(batch);
+	}
+}
+
+void clear()
+{
+	for (auto &p : pools)
+	{
+		p.x.clear(); p.y.clear();
+		p.vx.clear(); p.vy.clear();
+		p.life.clear(); p.size.clear();
+	}
+
+	live = 0;
+}
+
+int count()
+{
+	return live;
+}
+
+void report()
+{
+	LOG_INFO("Particles: ", peak, " peak of ", budget, ", ", merged, " merged, ", shed, " shed, ",
+		frames ? totalMs / frames : 0.0, " ms/tick avg, ", worstMs, " ms worst");
+}
+
+} // end namespace
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+
+// particle effects
+// ================
+// Visual only: bursts are spawned by gameplay events but particles never
+// affect the simulation and are not part of rollback snapshots. Each
+// emitter keeps its particles in structure-of-arrays storage, updated 4 at
+// a time with SSE2 and drawn as one solid rect batch.
+namespace particles {
+
+	// burst settings, one per enemy type in enemies.conf
+	struct emitter {
+		SDL_Color color = {255, 255, 255, 255};
+		int count = 16; // particles per burst
+		float speed = 3; // max px per tick at birth
+		int life = 30; // ticks
+		int size = 4; // px at birth, shrinks over life
+	};
+
+	// emitters that exist without config, enemies.conf can override them
+	enum BuiltinEmitters
+	{
+		PLAYER_DEATH,
+		BULLET_CANCEL,
+		BUILTIN_TOTAL
+	};
+
+	// add or replace emitter, returns its id
+	extern int define(const std::string &name, const emitter &e);
+
+	// id of named emitter, -1 if none
+	extern int find(const std::string &name);
+
+	// live particle cap, bursts beyond it are merged into fewer, larger
+	// particles and shed once no room is left
+	extern void setBudget(const int &maxParticles);
+
+	// spawn a burst at x, y, or hold it for confirm()
+	extern void emit(const int &id, const float &x, const float &y);
+
+	// netplay: hold bursts by tick until that tick can no longer be rolled
+	// back, so a mispredicted tick shows only what its replay emits;
+	// turning it on or off drops held bursts
+	extern void hold(const bool &on);
+
+	// spawn held bursts of ticks up to tick
+	extern void confirm(const Uint32 &tick);
+
+	// drop held bursts of tick and later, they are replayed
+	extern void rollback(const Uint32 &tick);
+
+	// advance every particle one tick
+	extern void update();
+
+	// append one rect batch per emitter to the current draw list
+	extern void submit();
+
+	extern void clear();
+
+	// particles alive now
+	extern int count();
+
+	// peak count, merged and shed particles, update cost
+	extern void report();
+
+} // end namespace
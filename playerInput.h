@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// buttons a player holds during one tick, the only thing sent over the network
+typedef Uint8 playerInput;
+
+enum InputButtons
+{
+	INPUT_UP = 1,
+	INPUT_DOWN = 2,
+	INPUT_LEFT = 4,
+	INPUT_RIGHT = 8,
+	INPUT_FIRE = 16,
+	INPUT_SLOW = 32
+};
+
+// sample keyboard into input buttons
+inline playerInput readPlayerInput(const Uint8* keyState)
+{
+	// player keybindings
+	// ==================
+	playerInput input = 0;
+
+	if (keyState[SDL_SCANCODE_UP]) input |= INPUT_UP;
+	if (keyState[SDL_SCANCODE_DOWN]) input |= INPUT_DOWN;
+	if (keyState[SDL_SCANCODE_LEFT]) input |= INPUT_LEFT;
+	if (keyState[SDL_SCANCODE_RIGHT]) input |= INPUT_RIGHT;
+	if (keyState[SDL_SCANCODE_Z]) input |= INPUT_FIRE;
+	if (keyState[SDL_SCANCODE_LSHIFT]) input |= INPUT_SLOW;
+
+	return input;
+}
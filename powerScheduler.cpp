@@ -0,0 +1,128 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <time.h>
+
+#include "global.h"
+#include "logger.h"
+#include "renderThread.h"
+#include "powerScheduler.h"
+
+namespace powerScheduler {
+
+const int IDLE_WAKE_MS = 250;
+
+static const char *names[STATE_TOTAL] = { "active", "unfocused", "hidden", "paused" };
+
+// ticks per second in each state, paused never ticks
+static int tickRates[STATE_TOTAL] = { global::TICK_RATE, global::TICK_RATE, 0, 0 };
+
+static bool focused = true;
+static bool shown = true;
+static bool background = false; // netplay, background rates ignored
+static int current = ACTIVE;
+
+// time spent in each state so far, seconds
+static double wallSeconds[STATE_TOTAL];
+static double cpuSeconds[STATE_TOTAL];
+static Uint64 enteredWall = 0;
+static double enteredCpu = 0;
+
+static double processCpu()
+{
+	timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// charge time since the last switch to the current state
+static void account()
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	double cpu = processCpu();
+
+	if (enteredWall != 0)
+	{
+		wallSeconds[current] += (double)(now - enteredWall) / SDL_GetPerformanceFrequency();
+		cpuSeconds[current] += cpu - enteredCpu;
+	}
+
+	enteredWall = now;
+	enteredCpu = cpu;
+}
+
+void setTickRate(const int &state, const int &ticksPerSecond)
+{
+	if (state == UNFOCUSED || state == HIDDEN)
+		tickRates[state] = std::max(0, std::min(ticksPerSecond, global::TICK_RATE));
+}
+
+void handle(const SDL_Event &event)
+{
+	if (event.type != SDL_WINDOWEVENT)
+		return;
+
+	switch (event.window.event)
+	{
+	case SDL_WINDOWEVENT_FOCUS_GAINED: focused = true; break;
+	case SDL_WINDOWEVENT_FOCUS_LOST: focused = false; break;
+	case SDL_WINDOWEVENT_SHOWN:
+	case SDL_WINDOWEVENT_RESTORED: shown = true; break;
+	case SDL_WINDOWEVENT_HIDDEN:
+	case SDL_WINDOWEVENT_MINIMIZED: shown = false; break;
+	}
+}
+
+bool update(const bool &paused, const bool &netplay)
+{
+	if (enteredWall == 0)
+		account();
+
+	background = netplay;
+	int next = paused ? PAUSED : !shown ? HIDDEN : !focused ? UNFOCUSED : ACTIVE;
+	if (next == current)
+		return false;
+
+	account();
+	LOG_DEBUG("Power state ", names[current], " -> ", names[next]);
+	current = next;
+	return true;
+}
+
+int state()
+{
+	return current;
+}
+
+bool idle()
+{
+	return current == PAUSED || (!background && tickRates[current] == 0);
+}
+
+bool visible()
+{
+	return current != HIDDEN;
+}
+
+double tickMs()
+{
+	int rate = background || tickRates[current] == 0 ? global::TICK_RATE : tickRates[current];
+	return 1000.0 / rate;
+}
+
+void report()
+{
+	account();
+
+	for (int s = 0; s < STATE_TOTAL; s++)
+	{
+		if (wallSeconds[s] <= 0)
+			continue;
+
+		LOG_INFO("Power ", names[s], ": ", wallSeconds[s], " s, ", cpuSeconds[s] * 1000 / wallSeconds[s], " ms CPU per second");
+	}
+
+	renderThread::stats frames = renderThread::frameTimes();
+	LOG_INFO("Presents: ", frames.frames, ", ", frames.skipped, " unchanged frames skipped");
+}
+
+} // end namespace
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// power-aware loop scheduling
+// ===========================
+// Picks how the game loop runs from pause and window state. Unfocused and
+// hidden windows tick at their own rates from config/video.conf; a rate of
+// 0, like pausing, stops ticking and the loop sleeps in the event queue
+// until something happens. Hidden windows submit no draw lists. Process
+// CPU time is accounted to each state for the report at exit.
+namespace powerScheduler {
+
+	enum States
+	{
+		ACTIVE,
+		UNFOCUSED,
+		HIDDEN, // minimized or occluded
+		PAUSED,
+		STATE_TOTAL
+	};
+
+	// longest idle sleep, bounds how stale live metrics get
+	extern const int IDLE_WAKE_MS;
+
+	// ticks per second while UNFOCUSED or HIDDEN, 0 to stop ticking, at most
+	// global::TICK_RATE
+	extern void setTickRate(const int &state, const int &ticksPerSecond);
+
+	// track focus and visibility from a window event
+	extern void handle(const SDL_Event &event);
+
+	// state for this loop pass, true if it changed; netplay ticks at full
+	// rate in the background since the peer waits on our inputs
+	extern bool update(const bool &paused, const bool &netplay);
+
+	extern int state();
+
+	// no ticks in this state, wait for events instead
+	extern bool idle();
+
+	// draw lists are worth submitting
+	extern bool visible();
+
+	// tick period in this state
+	extern double tickMs();
+
+	// wall and CPU time per state, skipped presents
+	extern void report();
+
+} // end namespace
@@ -0,0 +1,33 @@
+#include <SDL2/SDL.h>
+#include <string>
+
+#include "logger.h"
+#include "renderBackend.h"
+#include "sdlBackend.h"
+#include "cpuBackend.h"
+#include "nullBackend.h"
+
+renderBackend *createBackend(const std::string &name, SDL_Window *window)
+{
+	if (name == "cpu")
+		return new cpuBackend(window);
+
+	if (name == "null")
+		return new nullBackend();
+
+	if (name == "sdl")
+	{
+		SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+
+		if (renderer == nullptr)
+		{
+			LOG_ERROR("Could not init renderer: ", SDL_GetError());
+			return nullptr;
+		}
+
+		return new sdlBackend(renderer);
+	}
+
+	LOG_ERROR("Unknown renderer \"", name, "\"");
+	return nullptr;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+
+// texture owned by a render backend
+struct texture {
+	int width = 0;
+	int height = 0;
+
+	virtual ~texture() {}
+};
+
+// renderer interface
+// ==================
+// Everything is called from the render thread only, textures are created
+// and destroyed when it syncs the texture cache. Frames are drawn
+// into a target of scale% of the logical screen size, then upscaled to
+// the window by endFrame.
+class renderBackend {
+	public:
+
+	virtual ~renderBackend() {}
+
+	virtual const char *name() const = 0;
+
+	// copy surface pixels into a new texture, surface is not freed
+	virtual texture *createTexture(SDL_Surface *surface) = 0;
+	virtual void destroyTexture(texture *t) = 0;
+
+	// copy surface pixels into area of t, surface is area sized and not freed
+	virtual void updateTexture(texture *t, const SDL_Rect &area, SDL_Surface *surface) = 0;
+
+	// allocate render target up to maxScale %, false if scaling is unsupported
+	virtual bool initTarget(const int &maxScale) = 0;
+	virtual void releaseTarget() = 0;
+
+	// clear target
+	virtual void beginFrame(const int &scale) = 0;
+
+	// src nullptr for whole texture, dst in target coordinates
+	virtual void draw(const texture *t, const SDL_Rect *src, const SDL_Rect &dst) = 0;
+
+	// blend count solid rects in target coordinates, color is not premultiplied
+	virtual void fillRects(const SDL_Rect *rects, const int &count, const SDL_Color &color) = 0;
+
+	// upscale target to window
+	virtual void endFrame(const int &scale) = 0;
+
+	// copy the upscaled frame as window size ARGB8888, before present
+	virtual bool readFrame(Uint32 *pixels) = 0;
+
+	virtual void present() = 0;
+};
+
+// "sdl", "cpu" or "null", nullptr if the backend can't be created for window
+extern renderBackend *createBackend(const std::string &name, SDL_Window *window);
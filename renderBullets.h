@@ -9,13 +9,13 @@ void renderBullets(std::vector<gameObj> &bullets)
 	for (int i = 0; i < bullets.size(); i++)
 	{
 		// translate
-		bullets[i].rect.y += bullets[i].velocity;
+		bullets[i].rect.y += bullets[i].proto().velocity;
 
 		// remove bullet if offscreen
 		if (bullets[i].isOffscreen())
 			bullets.erase(bullets.begin() + i);
 		else
 			//render bullet
-			global::render(bullets[i].currentTexture, &bullets[i].rect);
+			bullets[i].draw(layer::BULLET);
 	}
 }
@@ -3,6 +3,8 @@
 #include <vector>
 #include "global.h"
 #include "gameObj.h"
+#include "telemetry.h"
+#include "particles.h"
 
 void renderEnemies(std::vector<gameObj> &enemies, std::vector<gameObj> &bullets)
 {
@@ -13,16 +15,24 @@ void renderEnemies(std::vector<gameObj> &enemies, std::vector<gameObj> &bullets)
 		if (!enemies[i].isOffscreen()) // if not offscreen
 		{
 			// render
-			global::render(enemies[i].currentTexture, &enemies[i].rect);
+			enemies[i].draw(layer::ENEMY);
 
 			// play animations
 			enemies[i].playAnimations();
+
+			// bosses are hit through their part hierarchy
+			if (enemies[i].boss >= 0)
+				continue;
 				
 			// check for player bullet collision
 			for (int j = 0; j < bullets.size(); j++)
 			{
+				global::collisionTests++;
 				if (SDL_HasIntersection(&enemies[i].rect, &bullets[j].rect))
 				{
+					telemetry::record(telemetry::EVENT_HIT, enemies[i].rect.x, enemies[i].rect.y);
+					particles::emit(enemies[i].proto().emitter, enemies[i].rect.x + enemies[i].rect.w / 2, enemies[i].rect.y + enemies[i].rect.h / 2);
+
 					enemies.erase(enemies.begin() + i);
 
 					bullets.erase(bullets.begin() + j);
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "global.h"
+#include "logger.h"
+#include "drawList.h"
+#include "tripleBuffer.h"
+#include "resolutionScaler.h"
+#include "renderBackend.h"
+#include "inputLatency.h"
+#include "frameCapture.h"
+#include "textureCache.h"
+#include "renderThread.h"
+
+namespace renderThread {
+
+static tripleBuffer<drawList> frames;
+static std::atomic<bool> running(false);
+static SDL_Thread *thread = nullptr;
+
+// posted on submit, so an idle render thread sleeps instead of polling
+static SDL_sem *wake = nullptr;
+static const int WAKE_MS = 100;
+static std::atomic<bool> redrawRequested(false);
+
+static drawList shown; // last presented, sorted
+static int shownScale = 0;
+
+static resolutionScaler scaler;
+static std::atomic<int> scalePercent(100);
+static stats frameStats;
+
+static std::vector<SDL_Rect> scaledRects; // batch rects at render scale
+
+static bool byLayer(const drawCmd &a, const drawCmd &b)
+{
+	return a.layer < b.layer;
+}
+
+// same commands, batches and rects in the same order
+static bool sameList(const drawList &a, const drawList &b)
+{
+	if (a.cmds.size() != b.cmds.size() || a.batches.size() != b.batches.size() || a.rects.size() != b.rects.size())
+		return false;
+
+	for (size_t i = 0; i < a.cmds.size(); i++)
+	{
+		const drawCmd &x = a.cmds[i];
+		const drawCmd &y = b.cmds[i];
+		if (x.tex != y.tex || x.layer != y.layer || memcmp(&x.src, &y.src, sizeof(SDL_Rect)) != 0 || memcmp(&x.dst, &y.dst, sizeof(SDL_Rect)) != 0)
+			return false;
+	}
+
+	for (size_t i = 0; i < a.batches.size(); i++)
+	{
+		const rectBatch &x = a.batches[i];
+		const rectBatch &y = b.batches[i];
+		if (memcmp(&x.color, &y.color, sizeof(SDL_Color)) != 0 || x.layer != y.layer || x.first != y.first || x.count != y.count)
+			return false;
+	}
+
+	return a.rects.empty() || memcmp(a.rects.data(), b.rects.data(), a.rects.size() * sizeof(SDL_Rect)) == 0;
+}
+
+// logical rect to render target rect at scale, edges rounded so neighbours don't gap
+static SDL_Rect scaleRect(const SDL_Rect &r, const int &percent)
+{
+	int x0 = r.x * percent / 100;
+	int y0 = r.y * percent / 100;
+	int x1 = (r.x + r.w) * percent / 100;
+	int y1 = (r.y + r.h) * percent / 100;
+
+	return global::makeRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static int renderLoop(void *)
+{
+	// offscreen target at max scale, lower scales use its top left corner
+	bool scaling = global::backend->initTarget(scaler.config().maxScale);
+
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+
+	// uploaded or updated since the last present, the same list may look different
+	bool texturesChanged = true;
+
+	while (running.load(std::memory_order_acquire))
+	{
+		// uploads and evictions before taking a list that may depend on them
+		if (textureCache::sync())
+			texturesChanged = true;
+
+		// sleep until a new tick or a redraw
+		bool fresh = frames.acquire();
+		bool exposed = redrawRequested.exchange(false);
+		if (!fresh && !exposed)
+		{
+			SDL_SemWaitTimeout(wake, WAKE_MS);
+			continue;
+		}
+
+		Uint64 frameStart = SDL_GetPerformanceCounter();
+		int scale = scaling ? scaler.scale() : 100;
+
+		// a redraw shows the last list again, it stays in the read buffer
+		drawList &list = frames.readBuffer();
+		std::vector<drawCmd> &cmds = list.cmds;
+		std::stable_sort(cmds.begin(), cmds.end(), byLayer);
+
+		// nothing would change on screen; capture wants every frame
+		if (!exposed && !texturesChanged && scale == shownScale && !frameCapture::enabled() && sameList(list, shown))
+		{
+			frameStats.skipped++;
+			continue;
+		}
+
+		shown.cmds = list.cmds;
+		shown.batches = list.batches;
+		shown.rects = list.rects;
+		shownScale = scale;
+		texturesChanged = false;
+
+		global::backend->beginFrame(scale);
+
+		// sprites and rect batches interleaved by layer
+		size_t next = 0;
+		for (int l = 0; l < layer::TOTAL; l++)
+		{
+			for (; next < cmds.size() && cmds[next].layer == l; next++)
+			{
+				const drawCmd &cmd = cmds[next];
+
+				// reloaded after an eviction and not uploaded yet, or upload failed
+				if (cmd.tex->tex == nullptr) continue;
+
+				SDL_Rect dst = scale == 100 ? cmd.dst : scaleRect(cmd.dst, scale);
+				global::backend->draw(cmd.tex->tex, cmd.src.w ? &cmd.src : nullptr, dst);
+			}
+
+			for (auto &batch : list.batches)
+			{
+				if (batch.layer != l) continue;
+
+				const SDL_Rect *rects = &list.rects[batch.first];
+				if (scale != 100)
+				{
+					scaledRects.resize(batch.count);
+					for (int i = 0; i < batch.count; i++)
+						scaledRects[i] = scaleRect(rects[i], scale);
+					rects = scaledRects.data();
+				}
+
+				global::backend->fillRects(rects, batch.count, batch.color);
+			}
+		}
+
+		// upscale to window
+		global::backend->endFrame(scale);
+
+		// read back for capture, dropped if encoders are behind; a redraw
+		// shows no new tick, so it isn't a frame of the video
+		if (frameCapture::enabled() && fresh)
+		{
+			Uint32 *pixels = frameCapture::acquire(list.tick);
+			if (pixels && global::backend->readFrame(pixels))
+				frameCapture::submit();
+			else
+				frameCapture::discard();
+		}
+
+		global::backend->present();
+		inputLatency::presented(list.inputStamp);
+
+		double frameMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0 / frequency;
+
+		frameStats.frames++;
+		frameStats.totalMs += frameMs;
+		if (frameMs > frameStats.worstMs)
+			frameStats.worstMs = frameMs;
+
+		if (scaling && scaler.update(frameMs))
+		{
+			scalePercent = scaler.scale();
+			LOG_INFO_RATE(2, "Render scale ", scaler.scale(), "% (", scaler.averageMs(), " ms/frame)");
+		}
+	}
+
+	global::backend->releaseTarget();
+
+	return 0;
+}
+
+drawList &currentList()
+{
+	return frames.writeBuffer();
+}
+
+void submit()
+{
+	frames.writeBuffer().tick = global::ticks;
+	frames.publish();
+	frames.writeBuffer().clear();
+	SDL_SemPost(wake);
+}
+
+void discard()
+{
+	frames.writeBuffer().clear();
+}
+
+void redraw()
+{
+	redrawRequested = true;
+	SDL_SemPost(wake);
+}
+
+int scale()
+{
+	return scalePercent.load(std::memory_order_relaxed);
+}
+
+stats frameTimes()
+{
+	return frameStats;
+}
+
+bool start(const resolutionScaler::settings &video)
+{
+	frameStats = stats();
+	scaler = resolutionScaler(video);
+	scalePercent = scaler.scale();
+
+	shown.clear();
+	shownScale = 0;
+	wake = SDL_CreateSemaphore(0);
+
+	running = true;
+	thread = SDL_CreateThread(renderLoop, "render", nullptr);
+
+	if (thread == nullptr)
+	{
+		running = false;
+		LOG_ERROR("Could not create render thread: ", SDL_GetError());
+		return false;
+	}
+
+	LOG_DEBUG("Started render thread");
+	return true;
+}
+
+void stop()
+{
+	if (thread == nullptr) return;
+
+	running = false;
+	SDL_SemPost(wake);
+	SDL_WaitThread(thread, nullptr);
+	thread = nullptr;
+
+	SDL_DestroySemaphore(wake);
+	wake = nullptr;
+
+	LOG_DEBUG("Stopped render thread");
+}
+
+} // end namespace
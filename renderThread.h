@@ -0,0 +1,40 @@
+#pragma once
+
+#include "drawList.h"
+#include "resolutionScaler.h"
+
+// render thread, consumes draw lists published by the simulation
+// =============================================================
+namespace renderThread {
+
+	// draw list for the tick being simulated (simulation thread only)
+	extern drawList &currentList();
+
+	// hand current list to the render thread, start a new one
+	extern void submit();
+
+	// drop current list unseen, start a new one
+	extern void discard();
+
+	// present the last list again, e.g. after the window was exposed
+	extern void redraw();
+
+	// current render target scale, % of logical screen size
+	extern int scale();
+
+	// render cost of presented frames
+	struct stats {
+		int frames = 0;
+		double totalMs = 0;
+		double worstMs = 0;
+		int skipped = 0; // lists identical to the one on screen
+	};
+
+	// only valid after stop()
+	extern stats frameTimes();
+
+	// backend must not be touched by other threads between start and stop
+	extern bool start(const resolutionScaler::settings &video);
+	extern void stop();
+
+} // end namespace
@@ -0,0 +1,42 @@
+#include <algorithm>
+
+#include "resolutionScaler.h"
+
+// weight of newest frame in the moving average
+static const double SMOOTHING = 0.1;
+
+resolutionScaler::resolutionScaler() : resolutionScaler(settings())
+{
+}
+
+resolutionScaler::resolutionScaler(const settings &config)
+{
+	s = config;
+	s.minScale = std::max(1, std::min(s.minScale, 100));
+	s.maxScale = std::max(s.minScale, std::min(s.maxScale, 100));
+	s.step = std::max(1, s.step);
+	current = s.maxScale;
+}
+
+bool resolutionScaler::update(const double &frameMs)
+{
+	average = average == 0 ? frameMs : average + (frameMs - average) * SMOOTHING;
+
+	if (++framesSinceChange < s.cooldown)
+		return false;
+
+	double slack = s.budgetMs * s.hysteresis / 100.0;
+	int next = current;
+
+	if (average > s.budgetMs + slack) // over budget: drop resolution
+		next = std::max(s.minScale, current - s.step);
+	else if (average < s.budgetMs - slack) // headroom: raise resolution
+		next = std::min(s.maxScale, current + s.step);
+
+	if (next == current)
+		return false;
+
+	current = next;
+	framesSinceChange = 0;
+	return true;
+}
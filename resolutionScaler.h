@@ -0,0 +1,37 @@
+#pragma once
+
+// render scale controller
+// =======================
+// Picks the resolution of the offscreen render target from measured frame
+// times. Scale is a percentage of the logical screen size.
+class resolutionScaler {
+	public:
+
+	// loaded from config/video.conf
+	struct settings {
+		int budgetMs = 16; // frame time to hold
+		int minScale = 50;
+		int maxScale = 100;
+		int step = 10; // scale change per adjustment
+		int hysteresis = 15; // % of budget frame time must be off by before adjusting
+		int cooldown = 30; // frames to wait after an adjustment
+	};
+
+	resolutionScaler();
+	resolutionScaler(const settings &config);
+
+	// feed one frame's time, returns true if scale changed
+	bool update(const double &frameMs);
+
+	int scale() const { return current; }
+	double averageMs() const { return average; }
+
+	const settings &config() const { return s; }
+
+	private:
+
+	settings s;
+	int current;
+	double average = 0;
+	int framesSinceChange = 0;
+};
@@ -0,0 +1,213 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+#include "global.h"
+#include "logger.h"
+#include "netTransport.h"
+#include "telemetry.h"
+#include "particles.h"
+#include "rollback.h"
+
+// ms of silence before peer counts as gone
+static const Uint32 DISCONNECT_TIMEOUT = 5000;
+
+rollbackSession::rollbackSession(const int &localPlayer) : local(localPlayer)
+{
+	std::fill(localInputs, localInputs + HISTORY, 0);
+	std::fill(remoteInputs, remoteInputs + HISTORY, 0);
+	std::fill(remoteUsed, remoteUsed + HISTORY, 0);
+	std::fill(checksums, checksums + HISTORY, 0);
+
+	simulated = global::ticks;
+	remoteConfirmed = global::ticks;
+	remoteAck = global::ticks;
+	checked = global::ticks;
+	compared = global::ticks;
+
+	telemetry::hold(true);
+	particles::hold(true);
+}
+
+rollbackSession::~rollbackSession()
+{
+	telemetry::hold(false);
+	particles::hold(false);
+}
+
+void rollbackSession::poll()
+{
+	// receive remote inputs
+	// =====================
+	packet in;
+	int size;
+
+	while ((size = netTransport::receive(&in, sizeof(in))) > 0)
+	{
+		if (size < (int)(sizeof(in) - sizeof(in.inputs)) || in.count > PACKET_INPUTS)
+			continue; // not ours
+
+		connected = true;
+		lastHeard = SDL_GetTicks();
+
+		if (SDL_TICKS_PASSED(in.ack, remoteAck + 1))
+			remoteAck = in.ack;
+
+		if (SDL_TICKS_PASSED(in.checkTick, remoteCheckTick + 1))
+		{
+			remoteCheckTick = in.checkTick;
+			remoteChecksum = in.checksum;
+		}
+
+		// take inputs continuing the confirmed run, late duplicates are ignored
+		for (Uint32 i = 0; i < in.count; i++)
+		{
+			Uint32 tick = in.first + i;
+			if (tick != remoteConfirmed + 1) continue;
+
+			remoteInputs[tick % HISTORY] = in.inputs[i];
+			remoteConfirmed = tick;
+
+			// already simulated with a wrong guess
+			if (tick <= simulated && remoteUsed[tick % HISTORY] != in.inputs[i] && (rollbackFrom == 0 || tick < rollbackFrom))
+				rollbackFrom = tick;
+		}
+	}
+
+	// keep resending while waiting, peer may have started after us
+	if (stalled())
+		send();
+
+	if (rollbackFrom == 0)
+	{
+		confirm();
+		return;
+	}
+
+	// rollback and resimulate
+	// =======================
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	gameState::restore(snapshots[rollbackFrom % SNAPSHOTS]);
+
+	// events of the mispredicted ticks never happened, the replay records
+	// and emits the real ones; drawing waits for the next tick
+	telemetry::rollback(rollbackFrom);
+	particles::rollback(rollbackFrom);
+	global::resimulating = true;
+
+	for (Uint32 tick = rollbackFrom; tick <= simulated; tick++)
+	{
+		gameState::save(snapshots[tick % SNAPSHOTS]);
+		gameState::stepWorld();
+		stepPlayers(tick);
+		resimulatedTicks++;
+	}
+
+	global::resimulating = false;
+
+	double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+	rollbacks++;
+	totalResimMs += ms;
+	worstResimMs = std::max(worstResimMs, ms);
+
+	// resimulation eats into the frame, warn when it takes half of one
+	if (ms > 500.0 / global::TICK_RATE)
+		LOG_WARN_RATE(1, "Rollback of ", simulated - rollbackFrom + 1, " ticks took ", ms, " ms");
+
+	rollbackFrom = 0;
+	confirm();
+}
+
+bool rollbackSession::stalled() const
+{
+	return (Sint32)(simulated - remoteConfirmed) >= MAX_ROLLBACK;
+}
+
+bool rollbackSession::disconnected() const
+{
+	return connected && SDL_TICKS_PASSED(SDL_GetTicks(), lastHeard + DISCONNECT_TIMEOUT);
+}
+
+void rollbackSession::beginTick()
+{
+	gameState::save(snapshots[(simulated + 1) % SNAPSHOTS]);
+}
+
+void rollbackSession::endTick(const playerInput &localInput)
+{
+	simulated++;
+	localInputs[simulated % HISTORY] = localInput;
+
+	stepPlayers(simulated);
+	send();
+	confirm();
+}
+
+void rollbackSession::stepPlayers(const Uint32 &tick)
+{
+	// predict remote input as the last confirmed one
+	playerInput remote = remoteInputs[std::min(tick, remoteConfirmed) % HISTORY];
+	remoteUsed[tick % HISTORY] = remote;
+
+	playerInput inputs[2];
+	inputs[local] = localInputs[tick % HISTORY];
+	inputs[1 - local] = remote;
+
+	gameState::stepPlayers(inputs);
+}
+
+void rollbackSession::confirm()
+{
+	// ticks simulated with confirmed remote input are final
+	Uint32 tick = std::min(simulated, remoteConfirmed);
+	telemetry::confirm(tick);
+	particles::confirm(tick);
+
+	// the state a final tick starts from is final too, and its snapshot is
+	// still kept since stalling bounds how far simulated runs ahead
+	while (checked < tick)
+	{
+		checked++;
+		checksums[checked % HISTORY] = gameState::checksum(snapshots[checked % SNAPSHOTS]);
+	}
+
+	compareChecksums();
+}
+
+void rollbackSession::compareChecksums()
+{
+	if (remoteCheckTick <= compared || remoteCheckTick > checked || checked - remoteCheckTick >= HISTORY)
+		return;
+
+	compared = remoteCheckTick;
+	stateChecks++;
+
+	if (checksums[compared % HISTORY] != remoteChecksum)
+	{
+		desyncs++;
+		LOG_ERROR_RATE(1, "Desync with peer at tick ", compared);
+	}
+}
+
+void rollbackSession::send()
+{
+	// resend inputs the peer has not confirmed yet, oldest first
+	packet out;
+	out.ack = remoteConfirmed;
+	out.checkTick = checked;
+	out.checksum = checksums[checked % HISTORY];
+	out.first = std::max(remoteAck + 1, simulated >= HISTORY ? simulated - HISTORY + 1 : 1);
+	out.count = simulated >= out.first ? std::min<Uint32>(simulated - out.first + 1, PACKET_INPUTS) : 0;
+
+	for (Uint32 i = 0; i < out.count; i++)
+		out.inputs[i] = localInputs[(out.first + i) % HISTORY];
+
+	netTransport::send(&out, sizeof(out) - sizeof(out.inputs) + out.count);
+}
+
+void rollbackSession::report() const
+{
+	LOG_INFO("Rollbacks: ", rollbacks, ", ", resimulatedTicks, " ticks resimulated, ",
+		rollbacks ? totalResimMs / rollbacks : 0.0, " ms avg, ", worstResimMs, " ms worst");
+	LOG_INFO("State checks: ", stateChecks, ", ", desyncs, " desyncs");
+}
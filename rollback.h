@@ -0,0 +1,97 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include "playerInput.h"
+#include "gameState.h"
+
+// rollback netplay
+// ================
+// Both peers simulate every tick right away, predicting the remote input
+// as its last confirmed one. When the real input arrives and differs, the
+// state is restored to that tick and replayed with the confirmed inputs.
+// Telemetry events and particle bursts are held until their tick is
+// confirmed, so those of mispredicted ticks are dropped rather than kept.
+// Peers also send a checksum of the state at their newest confirmed tick
+// and log a desync when it differs from their own for that tick.
+class rollbackSession
+{
+public:
+	// ticks simulated ahead of remote input before stalling
+	static const int MAX_ROLLBACK = 8;
+
+	// localPlayer is this peer's index into gameState::players (0 or 1)
+	rollbackSession(const int &localPlayer);
+	~rollbackSession();
+
+	// receive remote inputs and resimulate mispredicted ticks
+	void poll();
+
+	// too far ahead of remote, wait for it this tick
+	bool stalled() const;
+
+	// peer silent for too long after connecting
+	bool disconnected() const;
+
+	// snapshot state before the world step of the next tick
+	void beginTick();
+
+	// record local input, send it and step players with both inputs
+	void endTick(const playerInput &local);
+
+	// rollback counts, resimulation cost and state checks
+	void report() const;
+
+private:
+	static const int HISTORY = 64; // input ring, power of 2
+	static const int PACKET_INPUTS = 32;
+	static const int SNAPSHOTS = MAX_ROLLBACK + 2;
+
+	// wire format, inputs for ticks first .. first + count - 1
+	struct packet {
+		Uint32 ack; // newest of our inputs the peer confirmed
+		Uint32 checkTick; // newest tick whose starting state is final
+		Uint32 checksum; // gameState::checksum of it
+		Uint32 first;
+		Uint8 count;
+		playerInput inputs[PACKET_INPUTS];
+	};
+
+	void stepPlayers(const Uint32 &tick);
+	void send();
+
+	// release held telemetry and particles of final ticks, checksum them
+	void confirm();
+
+	// compare the peer's newest checksum with ours for that tick
+	void compareChecksums();
+
+	int local;
+
+	playerInput localInputs[HISTORY];
+	playerInput remoteInputs[HISTORY]; // confirmed remote inputs
+	playerInput remoteUsed[HISTORY]; // remote input each tick was simulated with
+
+	Uint32 simulated = 0; // newest simulated tick
+	Uint32 remoteConfirmed = 0; // newest contiguous remote input
+	Uint32 remoteAck = 0; // newest local input the peer has
+	Uint32 rollbackFrom = 0; // oldest mispredicted tick, 0 for none
+
+	gameState::snapshot snapshots[SNAPSHOTS]; // state before tick, by tick
+
+	Uint32 checksums[HISTORY]; // of snapshots of final ticks
+	Uint32 checked = 0; // newest tick in checksums
+	Uint32 remoteCheckTick = 0;
+	Uint32 remoteChecksum = 0;
+	Uint32 compared = 0; // newest tick compared with the peer
+
+	bool connected = false;
+	Uint32 lastHeard = 0;
+
+	// stats
+	int rollbacks = 0;
+	int resimulatedTicks = 0;
+	double worstResimMs = 0;
+	double totalResimMs = 0;
+	int stateChecks = 0;
+	int desyncs = 0;
+};
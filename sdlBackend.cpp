@@ -0,0 +1,130 @@
+#include <SDL2/SDL.h>
+
+#include "global.h"
+#include "logger.h"
+#include "sdlBackend.h"
+
+sdlBackend::sdlBackend(SDL_Renderer *r)
+{
+	renderer = r;
+	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
+}
+
+sdlBackend::~sdlBackend()
+{
+	releaseTarget();
+	SDL_DestroyRenderer(renderer);
+}
+
+texture *sdlBackend::createTexture(SDL_Surface *surface)
+{
+	SDL_Texture *handle = SDL_CreateTextureFromSurface(renderer, surface);
+	if (handle == nullptr)
+		return nullptr;
+
+	sdlTexture *t = new sdlTexture();
+	t->handle = handle;
+	t->width = surface->w;
+	t->height = surface->h;
+	return t;
+}
+
+void sdlBackend::destroyTexture(texture *t)
+{
+	if (t == nullptr) return;
+
+	SDL_DestroyTexture(static_cast<sdlTexture *>(t)->handle);
+	delete t;
+}
+
+void sdlBackend::updateTexture(texture *t, const SDL_Rect &area, SDL_Surface *surface)
+{
+	SDL_Texture *handle = static_cast<sdlTexture *>(t)->handle;
+
+	// texture format was picked by SDL_CreateTextureFromSurface
+	Uint32 format;
+	SDL_QueryTexture(handle, &format, nullptr, nullptr, nullptr);
+
+	SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+	if (converted == nullptr || SDL_UpdateTexture(handle, &area, converted->pixels, converted->pitch) < 0)
+		LOG_WARN_RATE(1, "Texture update failed: ", SDL_GetError());
+
+	if (converted)
+		SDL_FreeSurface(converted);
+}
+
+bool sdlBackend::initTarget(const int &maxScale)
+{
+	target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+		global::SCREEN_WIDTH * maxScale / 100, global::SCREEN_HEIGHT * maxScale / 100);
+
+	if (target == nullptr)
+	{
+		LOG_WARN("No render target support, resolution scaling disabled: ", SDL_GetError());
+		return false;
+	}
+
+	return true;
+}
+
+void sdlBackend::releaseTarget()
+{
+	if (target)
+		SDL_DestroyTexture(target);
+	target = nullptr;
+}
+
+void sdlBackend::beginFrame(const int &)
+{
+	if (target)
+		SDL_SetRenderTarget(renderer, target);
+
+	SDL_RenderClear(renderer);
+}
+
+void sdlBackend::draw(const texture *t, const SDL_Rect *src, const SDL_Rect &dst)
+{
+	if (SDL_RenderCopy(renderer, static_cast<const sdlTexture *>(t)->handle, src, &dst) < 0)
+		LOG_WARN_RATE(1, "Render copy failed: ", SDL_GetError());
+}
+
+void sdlBackend::fillRects(const SDL_Rect *rects, const int &count, const SDL_Color &color)
+{
+	SDL_SetRenderDrawBlendMode(renderer, color.a == 255 ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+
+	if (SDL_RenderFillRects(renderer, rects, count) < 0)
+		LOG_WARN_RATE(1, "Render fill failed: ", SDL_GetError());
+
+	// clear color for next frame
+	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
+}
+
+void sdlBackend::endFrame(const int &scale)
+{
+	// upscale to window
+	if (target)
+	{
+		SDL_Rect src = global::makeRect(0, 0, global::SCREEN_WIDTH * scale / 100, global::SCREEN_HEIGHT * scale / 100);
+		SDL_SetRenderTarget(renderer, nullptr);
+		SDL_RenderCopy(renderer, target, &src, nullptr);
+	}
+}
+
+bool sdlBackend::readFrame(Uint32 *pixels)
+{
+	SDL_Rect frame = global::makeRect(0, 0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT);
+
+	if (SDL_RenderReadPixels(renderer, &frame, SDL_PIXELFORMAT_ARGB8888, pixels, global::SCREEN_WIDTH * 4) < 0)
+	{
+		LOG_WARN_RATE(1, "Frame readback failed: ", SDL_GetError());
+		return false;
+	}
+
+	return true;
+}
+
+void sdlBackend::present()
+{
+	SDL_RenderPresent(renderer);
+}
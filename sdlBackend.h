@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include "renderBackend.h"
+
+// backend drawing through SDL_Renderer
+class sdlBackend : public renderBackend {
+	public:
+
+	// takes ownership of renderer
+	sdlBackend(SDL_Renderer *r);
+	~sdlBackend();
+
+	const char *name() const { return "sdl"; }
+
+	texture *createTexture(SDL_Surface *surface);
+	void destroyTexture(texture *t);
+	void updateTexture(texture *t, const SDL_Rect &area, SDL_Surface *surface);
+
+	bool initTarget(const int &maxScale);
+	void releaseTarget();
+
+	void beginFrame(const int &scale);
+	void draw(const texture *t, const SDL_Rect *src, const SDL_Rect &dst);
+	void fillRects(const SDL_Rect *rects, const int &count, const SDL_Color &color);
+	void endFrame(const int &scale);
+	bool readFrame(Uint32 *pixels);
+	void present();
+
+	private:
+
+	struct sdlTexture : public texture {
+		SDL_Texture *handle = nullptr;
+	};
+
+	SDL_Renderer *renderer;
+	SDL_Texture *target = nullptr; // offscreen target at max scale
+};
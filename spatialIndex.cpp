@@ -0,0 +1,207 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "gameObj.h"
+#include "spatialIndex.h"
+
+spatialIndex::spatialIndex(const int &width, const int &height, const int &size)
+{
+	// shifts instead of divides, refresh finds a cell for every object
+	shift = 0;
+	while ((1 << shift) < size)
+		shift++;
+
+	cellsX = (width + (1 << shift) - 1) >> shift;
+	cellsY = (height + (1 << shift) - 1) >> shift;
+	cells.resize(cellsX * cellsY);
+}
+
+// cells overlapping a box, clamped to the grid
+void spatialIndex::cellRange(const int &x0, const int &y0, const int &x1, const int &y1, int &cx0, int &cy0, int &cx1, int &cy1) const
+{
+	cx0 = std::min(std::max(x0 >> shift, 0), cellsX - 1);
+	cy0 = std::min(std::max(y0 >> shift, 0), cellsY - 1);
+	cx1 = std::min(std::max(x1 >> shift, 0), cellsX - 1);
+	cy1 = std::min(std::max(y1 >> shift, 0), cellsY - 1);
+}
+
+void spatialIndex::insert(const int &s, const int &cell)
+{
+	slots[s].cell = cell;
+	slots[s].pos = cells[cell].size();
+	cells[cell].push_back(s);
+}
+
+// swap the last slot of the cell into s's place
+void spatialIndex::remove(const int &s)
+{
+	std::vector<int> &c = cells[slots[s].cell];
+	int last = c.back();
+	c[slots[s].pos] = last;
+	slots[last].pos = slots[s].pos;
+	c.pop_back();
+}
+
+void spatialIndex::refresh(const std::vector<gameObj> &objs)
+{
+	count.refreshes++;
+
+	// merge with the last refresh, both sides are sorted by id; plain
+	// pointers keep the loop in registers, slots only grow on an add
+	scratch.resize(objs.size());
+	const live *prev = order.data();
+	const size_t prevSize = order.size();
+	live *next = scratch.data();
+	slot *all = slots.data();
+
+	size_t j = 0;
+	int widest = 0;
+
+	for (size_t i = 0; i < objs.size(); i++)
+	{
+		const SDL_Rect &r = objs[i].rect;
+		const Uint32 id = objs[i].id;
+		const int cell = cellOf(r.x + r.w / 2, r.y + r.h / 2);
+
+		assert(i == 0 || objs[i - 1].id < id);
+		widest = std::max(widest, std::max(r.w, r.h));
+
+		// gone since last refresh
+		for (; j < prevSize && prev[j].id < id; j++)
+		{
+			remove(prev[j].slot);
+			freeSlots.push_back(prev[j].slot);
+			count.removed++;
+		}
+
+		int s;
+		if (j < prevSize && prev[j].id == id)
+		{
+			s = prev[j++].slot;
+			if (all[s].cell != cell)
+			{
+				remove(s);
+				insert(s, cell);
+				count.moved++;
+			}
+		}
+		else
+		{
+			if (freeSlots.empty())
+			{
+				s = slots.size();
+				slots.push_back(slot());
+				all = slots.data();
+			}
+			else
+			{
+				s = freeSlots.back();
+				freeSlots.pop_back();
+			}
+
+			insert(s, cell);
+			count.added++;
+		}
+
+		all[s].index = i;
+		all[s].rect = r;
+		next[i].id = id;
+		next[i].slot = s;
+	}
+
+	for (; j < prevSize; j++)
+	{
+		remove(prev[j].slot);
+		freeSlots.push_back(prev[j].slot);
+		count.removed++;
+	}
+
+	order.swap(scratch);
+	reach = widest / 2 + 1;
+}
+
+void spatialIndex::clear()
+{
+	for (auto &c : cells)
+		c.clear();
+	slots.clear();
+	freeSlots.clear();
+	order.clear();
+}
+
+void spatialIndex::within(const SDL_Rect &area, const int &r, std::vector<int> &out) const
+{
+	out.clear();
+	if (order.empty())
+		return;
+
+	count.queries++;
+
+	// centres that could put a rect within r
+	int cx0, cy0, cx1, cy1;
+	int pad = r + reach;
+	cellRange(area.x - pad, area.y - pad, area.x + area.w + pad, area.y + area.h + pad, cx0, cy0, cx1, cy1);
+
+	for (int cy = cy0; cy <= cy1; cy++)
+	{
+		for (int cx = cx0; cx <= cx1; cx++)
+		{
+			for (auto &s : cells[cy * cellsX + cx])
+			{
+				const SDL_Rect &b = slots[s].rect;
+				int i = slots[s].index;
+				count.candidates++;
+
+				// gap between the rects on each axis, 0 if they overlap
+				int dx = std::max(0, std::max(area.x - (b.x + b.w), b.x - (area.x + area.w)));
+				int dy = std::max(0, std::max(area.y - (b.y + b.h), b.y - (area.y + area.h)));
+
+				if (dx * dx + dy * dy <= r * r)
+					out.push_back(i);
+			}
+		}
+	}
+
+	std::sort(out.begin(), out.end());
+}
+
+int spatialIndex::nearest(const int &x, const int &y, const int &r) const
+{
+	if (order.empty())
+		return -1;
+
+	count.queries++;
+
+	int cx0, cy0, cx1, cy1;
+	cellRange(x - r, y - r, x + r, y + r, cx0, cy0, cx1, cy1);
+
+	int best = -1;
+	int bestDist = r * r;
+
+	for (int cy = cy0; cy <= cy1; cy++)
+	{
+		for (int cx = cx0; cx <= cx1; cx++)
+		{
+			for (auto &s : cells[cy * cellsX + cx])
+			{
+				const SDL_Rect &b = slots[s].rect;
+				int i = slots[s].index;
+				count.candidates++;
+
+				int dx = b.x + b.w / 2 - x;
+				int dy = b.y + b.h / 2 - y;
+				int d = dx * dx + dy * dy;
+
+				if (d < bestDist || (d == bestDist && best >= 0 && i < best))
+				{
+					bestDist = d;
+					best = i;
+				}
+			}
+		}
+	}
+
+	return best;
+}
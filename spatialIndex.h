@@ -0,0 +1,89 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+class gameObj;
+
+// spatial index
+// =============
+// Uniform grid of objects by the cell holding their centre. Each object
+// keeps a slot for as long as it lives, holding a compact copy of its rect
+// and index, and cells list slots. refresh() pairs objects with their
+// slots in one merge by id, so objects must be kept sorted by id (push_back
+// with rising ids, erase in place). Only objects that were added, removed
+// or crossed into another cell change the grid, and queries read slots
+// without touching the objects.
+class spatialIndex {
+	public:
+
+	// covers width x height, objects outside are kept in the edge cells;
+	// cellSize is rounded up to a power of two
+	spatialIndex(const int &width, const int &height, const int &cellSize);
+
+	// bring the grid up to date, queries answer for objects as they were here
+	void refresh(const std::vector<gameObj> &objects);
+
+	// forget every object
+	void clear();
+
+	// indices of objects whose rect is within r of area, in ascending order
+	void within(const SDL_Rect &area, const int &r, std::vector<int> &out) const;
+
+	// index of the object whose centre is nearest (x, y) and closer than r,
+	// lowest index on ties; -1 if none
+	int nearest(const int &x, const int &y, const int &r) const;
+
+	struct stats {
+		long refreshes = 0;
+		long added = 0;
+		long removed = 0;
+		long moved = 0; // changed cell
+		long queries = 0;
+		long candidates = 0; // objects looked at by queries
+	};
+
+	stats counters() const { return count; }
+
+	private:
+
+	struct slot {
+		int index; // in objects as of the last refresh
+		SDL_Rect rect;
+		int cell;
+		int pos; // in cells[cell]
+	};
+
+	int shift; // log2 of cell size
+	int cellsX;
+	int cellsY;
+
+	std::vector<std::vector<int>> cells; // slot numbers
+	std::vector<slot> slots;
+	std::vector<int> freeSlots;
+	// live ids and their slots by id, as of the last refresh
+	struct live {
+		Uint32 id;
+		int slot;
+	};
+
+	std::vector<live> order;
+	std::vector<live> scratch;
+
+	int reach = 0; // largest half width or height, how far a rect spills out of its cell
+
+	mutable stats count;
+
+	int cellOf(int x, int y) const
+	{
+		x = x >> shift;
+		y = y >> shift;
+		x = x < 0 ? 0 : x < cellsX ? x : cellsX - 1;
+		y = y < 0 ? 0 : y < cellsY ? y : cellsY - 1;
+		return y * cellsX + x;
+	}
+
+	void cellRange(const int &x0, const int &y0, const int &x1, const int &y1, int &cx0, int &cy0, int &cx1, int &cy1) const;
+	void insert(const int &s, const int &cell);
+	void remove(const int &s);
+};
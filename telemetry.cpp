@@ -0,0 +1,191 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "global.h"
+#include "logger.h"
+#include "telemetry.h"
+
+namespace telemetry {
+
+const int SAMPLE_INTERVAL = 8;
+
+// ring capacity, power of two
+static const std::uint32_t RING_SIZE = 1 << 16;
+static const std::uint32_t RING_MASK = RING_SIZE - 1;
+
+// writer drains this many events per fwrite
+static const std::uint32_t WRITE_BATCH = 4096;
+
+static telemetryEvent ring[RING_SIZE];
+static std::atomic<std::uint32_t> head(0); // next slot to write, owned by game loop
+static std::atomic<std::uint32_t> tail(0); // next slot to read, owned by writer
+
+static std::atomic<bool> running(false);
+static bool isEnabled = false;
+static std::uint16_t currentWave = 0;
+static std::uint32_t dropped = 0;
+static std::uint32_t recorded = 0;
+
+// events of ticks netplay may still roll back, game loop only
+static bool holding = false;
+static std::vector<telemetryEvent> held;
+
+static FILE *logFile = nullptr;
+static SDL_Thread *thread = nullptr;
+
+// write everything queued so far, returns number of events written
+static std::uint32_t drain()
+{
+	static telemetryEvent batch[WRITE_BATCH];
+
+	std::uint32_t t = tail.load(std::memory_order_relaxed);
+	std::uint32_t h = head.load(std::memory_order_acquire);
+	std::uint32_t total = h - t;
+
+	while (t != h)
+	{
+		std::uint32_t n = 0;
+		for (; n < WRITE_BATCH && t != h; n++, t++)
+			batch[n] = ring[t & RING_MASK];
+
+		// release slots before hitting the disk
+		tail.store(t, std::memory_order_release);
+		fwrite(batch, sizeof(telemetryEvent), n, logFile);
+	}
+
+	return total;
+}
+
+static int writerLoop(void *)
+{
+	while (running.load(std::memory_order_acquire))
+	{
+		if (drain() == 0)
+			SDL_Delay(5);
+	}
+
+	drain();
+	return 0;
+}
+
+bool start(const std::string &fileName)
+{
+	logFile = fopen(fileName.c_str(), "wb");
+	if (logFile == nullptr)
+	{
+		LOG_ERROR("Could not open telemetry log ", fileName);
+		return false;
+	}
+
+	telemetryHeader header;
+	memcpy(header.magic, MAGIC, sizeof(header.magic));
+	header.version = VERSION;
+	header.eventSize = sizeof(telemetryEvent);
+	header.sampleInterval = SAMPLE_INTERVAL;
+	header.screenWidth = global::SCREEN_WIDTH;
+	header.screenHeight = global::SCREEN_HEIGHT;
+	header.reserved = 0;
+	fwrite(&header, sizeof(header), 1, logFile);
+
+	running = true;
+	thread = SDL_CreateThread(writerLoop, "telemetry", nullptr);
+	if (thread == nullptr)
+	{
+		running = false;
+		fclose(logFile);
+		logFile = nullptr;
+		LOG_ERROR("Could not create telemetry thread: ", SDL_GetError());
+		return false;
+	}
+
+	isEnabled = true;
+	LOG_INFO("Recording telemetry to ", fileName);
+	return true;
+}
+
+void stop()
+{
+	if (!isEnabled) return;
+
+	isEnabled = false;
+	running = false;
+	SDL_WaitThread(thread, nullptr);
+	thread = nullptr;
+
+	fclose(logFile);
+	logFile = nullptr;
+
+	LOG_INFO("Telemetry: ", recorded, " events, ", dropped, " dropped");
+}
+
+bool enabled()
+{
+	return isEnabled;
+}
+
+void setWave(const int &wave)
+{
+	// batch-sim threads run waves with telemetry off, so this is never shared
+	if (!isEnabled) return;
+	currentWave = wave;
+}
+
+// queue for the writer, dropped if the ring is full
+static void push(const telemetryEvent &event)
+{
+	std::uint32_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= RING_SIZE)
+	{
+		dropped++;
+		return;
+	}
+
+	ring[h & RING_MASK] = event;
+	head.store(h + 1, std::memory_order_release);
+	recorded++;
+}
+
+void record(const int &type, const int &x, const int &y, const int &arg)
+{
+	if (!isEnabled) return;
+
+	telemetryEvent e = {};
+	e.tick = global::ticks;
+	e.x = x;
+	e.y = y;
+	e.type = type;
+	e.wave = currentWave;
+	e.arg = arg;
+
+	if (holding)
+		held.push_back(e);
+	else
+		push(e);
+}
+
+void hold(const bool &on)
+{
+	holding = on;
+	held.clear();
+}
+
+void confirm(const Uint32 &tick)
+{
+	size_t n = 0;
+	for (; n < held.size() && held[n].tick <= tick; n++)
+		push(held[n]);
+
+	held.erase(held.begin(), held.begin() + n);
+}
+
+void rollback(const Uint32 &tick)
+{
+	while (!held.empty() && held.back().tick >= tick)
+		held.pop_back();
+}
+
+} // end namespace
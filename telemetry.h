@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include "telemetryFormat.h"
+
+// gameplay telemetry
+// ==================
+// record() is called from the game loop and only writes to a lock-free
+// ring; a background thread drains the ring to a binary log file
+namespace telemetry {
+
+	// ticks between enemy bullet position samples
+	extern const int SAMPLE_INTERVAL;
+
+	// open log file and start writer thread
+	extern bool start(const std::string &fileName);
+
+	// flush remaining events, stop writer thread, close file
+	extern void stop();
+
+	extern bool enabled();
+
+	// current wave number stamped on each event
+	extern void setWave(const int &wave);
+
+	// queue an event, dropped (and counted) if the ring is full
+	extern void record(const int &type, const int &x, const int &y, const int &arg = 0);
+
+	// netplay: hold events by tick until that tick can no longer be rolled
+	// back, so the log keeps only what the confirmed inputs produced;
+	// turning it on or off drops held events
+	extern void hold(const bool &on);
+
+	// queue held events of ticks up to tick
+	extern void confirm(const Uint32 &tick);
+
+	// drop held events of tick and later, they are recorded again by the replay
+	extern void rollback(const Uint32 &tick);
+
+} // end namespace
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// binary telemetry log layout, shared by the game and tools/telemetryStats
+// file is a telemetryHeader followed by packed telemetryEvents
+namespace telemetry {
+
+	const char MAGIC[4] = { 'S', 'H', 'T', 'L' };
+	const std::uint16_t VERSION = 2;
+
+	enum EventType
+	{
+		EVENT_SPAWN, // enemy entered play
+		EVENT_FIRE, // arg: 0 player, 1 enemy
+		EVENT_HIT, // player bullet killed enemy
+		EVENT_DEATH, // player died
+		EVENT_WAVE_START,
+		EVENT_WAVE_END,
+		EVENT_BULLET, // periodic enemy bullet position sample
+		EVENT_PART_DESTROYED, // player bullet destroyed a boss part other than the root
+		EVENT_TOTAL
+	};
+
+	struct telemetryHeader {
+		char magic[4];
+		std::uint16_t version;
+		std::uint16_t eventSize;
+		std::uint16_t sampleInterval; // ticks between EVENT_BULLET samples
+		std::uint16_t screenWidth;
+		std::uint16_t screenHeight;
+		std::uint16_t reserved;
+	};
+
+	struct telemetryEvent {
+		std::uint32_t tick;
+		std::int16_t x;
+		std::int16_t y;
+		std::uint8_t type;
+		std::uint8_t reserved;
+		std::uint16_t wave; // wave index, configs may have more than 256
+		std::uint32_t arg;
+	};
+
+	static_assert(sizeof(telemetryHeader) == 16, "telemetry header must be packed");
+	static_assert(sizeof(telemetryEvent) == 16, "telemetry event must be packed");
+
+} // end namespace
@@ -0,0 +1,290 @@
+#include <map>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "assetPack.h"
+#include "global.h"
+#include "logger.h"
+#include "renderBackend.h"
+#include "textureCache.h"
+
+namespace textureCache {
+
+enum PendingKinds
+{
+	OP_UPLOAD,
+	OP_UPDATE, // copy surface into area
+	OP_DESTROY
+};
+
+struct pendingOp {
+	cachedTexture *entry;
+	int kind;
+	SDL_Surface *surface; // freed once applied
+	SDL_Rect area;
+};
+
+static std::map<std::string, cachedTexture *> entries;
+static size_t budget = 64 * 1024 * 1024;
+static Uint64 frame = 0; // draw list being built, counts submitted lists
+static stats counts;
+
+// game thread to render thread, in order so a reload follows its eviction
+static SDL_mutex *pendingLock = nullptr;
+static std::vector<pendingOp> pending;
+static std::vector<pendingOp> working; // render thread's copy
+
+static size_t sizeOf(const cachedTexture *entry)
+{
+	return (size_t)entry->width * entry->height * 4;
+}
+
+static void queue(cachedTexture *entry, const int &kind, SDL_Surface *surface = nullptr, const SDL_Rect &area = SDL_Rect())
+{
+	// first load happens before the render thread starts
+	if (pendingLock == nullptr)
+		pendingLock = SDL_CreateMutex();
+
+	SDL_LockMutex(pendingLock);
+	pending.push_back({entry, kind, surface, area});
+	SDL_UnlockMutex(pendingLock);
+}
+
+static void addBytes(const cachedTexture *entry)
+{
+	counts.residentBytes += sizeOf(entry);
+	if (counts.residentBytes > counts.peakBytes)
+		counts.peakBytes = counts.residentBytes;
+}
+
+// decode on the calling thread and queue the upload, packed copy first
+static bool load(cachedTexture *entry)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	SDL_Surface *surface = assetPack::load(entry->path);
+	bool packed = surface != nullptr;
+	if (!packed)
+		surface = IMG_Load(entry->path.c_str());
+	if (surface == nullptr)
+		return false;
+
+	entry->width = surface->w;
+	entry->height = surface->h;
+	entry->resident = true;
+	queue(entry, OP_UPLOAD, surface);
+
+	counts.loads++;
+	if (packed)
+		counts.packLoads++;
+	counts.loadMs += (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+	addBytes(entry);
+
+	LOG_DEBUG("Load texture successful: ", entry->path, packed ? " (packed)" : "");
+	return true;
+}
+
+cachedTexture *entry(const std::string &path)
+{
+	auto found = entries.find(path);
+	if (found != entries.end())
+		return found->second;
+
+	cachedTexture *entry = new cachedTexture();
+	entry->path = path;
+	entries[path] = entry;
+	return entry;
+}
+
+cachedTexture *acquire(const std::string &path)
+{
+	cachedTexture *found = entry(path);
+
+	if (!found->resident && !load(found))
+	{
+		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", std::string("Could not load \"" + path + "\".").c_str(), NULL);
+		LOG_ERROR("Unable to load texture: ", path, " : ", SDL_GetError());
+		exit(EXIT_FAILURE);
+	}
+
+	found->refs++;
+	return found;
+}
+
+cachedTexture *create(const std::string &name, SDL_Surface *surface)
+{
+	cachedTexture *found = entry(name);
+	if (found->resident)
+	{
+		LOG_WARN("Texture created twice: ", name);
+		SDL_FreeSurface(surface);
+		return found;
+	}
+
+	found->width = surface->w;
+	found->height = surface->h;
+	found->resident = true;
+	found->refs++;
+	queue(found, OP_UPLOAD, surface);
+
+	addBytes(found);
+	return found;
+}
+
+void update(cachedTexture *entry, const SDL_Rect &area, SDL_Surface *surface)
+{
+	queue(entry, OP_UPDATE, surface, area);
+}
+
+void release(const std::string &path)
+{
+	auto found = entries.find(path);
+	if (found == entries.end() || found->second->refs == 0)
+	{
+		LOG_WARN("Texture released more often than acquired: ", path);
+		return;
+	}
+
+	found->second->refs--;
+}
+
+cachedTexture *get(const std::string &path)
+{
+	return get(entry(path));
+}
+
+cachedTexture *get(cachedTexture *entry)
+{
+	if (entry->resident)
+		counts.hits++;
+	else if (entry->missing)
+		return nullptr;
+	else if (load(entry))
+		counts.misses++;
+	else
+	{
+		LOG_WARN("Unable to load texture: ", entry->path, " : ", SDL_GetError());
+		entry->missing = true;
+		return nullptr;
+	}
+
+	entry->lastUsed = frame;
+	return entry;
+}
+
+void setBudget(const size_t &bytes)
+{
+	budget = bytes;
+}
+
+void endFrame()
+{
+	frame++;
+
+	while (counts.residentBytes > budget)
+	{
+		// least recently drawn texture nothing holds; the render thread may
+		// take the list just submitted after the destroy, so its textures stay
+		cachedTexture *oldest = nullptr;
+		for (auto &e : entries)
+		{
+			cachedTexture *entry = e.second;
+			if (!entry->resident || entry->refs > 0 || entry->lastUsed + 1 >= frame)
+				continue;
+			if (oldest == nullptr || entry->lastUsed < oldest->lastUsed)
+				oldest = entry;
+		}
+
+		if (oldest == nullptr)
+		{
+			LOG_WARN_RATE(5, "Textures in use exceed budget: ", counts.residentBytes / 1024, " of ", budget / 1024, " KB");
+			break;
+		}
+
+		// the render thread may still be drawing an older list, it destroys this between frames
+		oldest->resident = false;
+		queue(oldest, OP_DESTROY);
+
+		counts.evictions++;
+		counts.residentBytes -= sizeOf(oldest);
+	}
+}
+
+bool sync()
+{
+	if (pendingLock == nullptr)
+		return false;
+
+	SDL_LockMutex(pendingLock);
+	working.swap(pending);
+	SDL_UnlockMutex(pendingLock);
+
+	bool changed = !working.empty();
+
+	for (auto &op : working)
+	{
+		if (op.kind == OP_UPLOAD)
+		{
+			op.entry->tex = global::backend->createTexture(op.surface);
+			if (op.entry->tex == nullptr)
+				LOG_WARN("Unable to upload texture: ", op.entry->path, " : ", SDL_GetError());
+		}
+		else if (op.kind == OP_UPDATE && op.entry->tex)
+			global::backend->updateTexture(op.entry->tex, op.area, op.surface);
+		else if (op.kind == OP_DESTROY && op.entry->tex)
+		{
+			global::backend->destroyTexture(op.entry->tex);
+			op.entry->tex = nullptr;
+		}
+
+		if (op.surface)
+			SDL_FreeSurface(op.surface);
+	}
+
+	working.clear();
+	return changed;
+}
+
+void clear()
+{
+	// uploads never taken by a render thread
+	if (global::backend)
+		sync();
+
+	for (auto &op : pending)
+		if (op.surface)
+			SDL_FreeSurface(op.surface);
+	pending.clear();
+
+	for (auto &e : entries)
+	{
+		if (e.second->tex && global::backend)
+			global::backend->destroyTexture(e.second->tex);
+		delete e.second;
+	}
+	entries.clear();
+
+	counts.residentBytes = 0;
+
+	if (pendingLock)
+		SDL_DestroyMutex(pendingLock);
+	pendingLock = nullptr;
+}
+
+stats counters()
+{
+	return counts;
+}
+
+void report()
+{
+	int draws = counts.hits + counts.misses;
+
+	LOG_INFO("Textures: ", draws ? counts.hits * 100.0 / draws : 100.0, "% hits, ", counts.misses, " misses, ",
+		counts.loads, " loads (", counts.packLoads, " packed, ", counts.loadMs, " ms), ", counts.evictions, " evictions, ", counts.residentBytes / 1024, " KB resident, ",
+		counts.peakBytes / 1024, " KB peak of ", budget / 1024, " KB");
+}
+
+} // end namespace
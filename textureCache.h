@@ -0,0 +1,81 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+
+struct texture;
+
+// image file shared by every object drawing it, entries live until clear()
+struct cachedTexture {
+	std::string path;
+	int width = 0;
+	int height = 0;
+
+	// render thread only, nullptr until uploaded and after eviction
+	texture *tex = nullptr;
+
+	// game thread only
+	int refs = 0; // prototypes and waves holding it
+	bool resident = false; // decoded, uploaded or queued for upload
+	bool missing = false; // failed to load on draw, not retried
+	Uint64 lastUsed = 0; // frame it was last drawn
+};
+
+// texture cache
+// =============
+// Images are keyed by path. Decoding happens on the game thread, uploads
+// and destroys are queued for the render thread, which owns the backend.
+// Once resident bytes exceed the budget, textures with no references are
+// evicted least recently drawn first, skipping any drawn in the last
+// published list. Destroys run between render thread frames, so a list
+// never loses a texture mid-draw.
+namespace textureCache {
+
+	// reference path, loading it now if needed; exits if it can't be loaded
+	extern cachedTexture *acquire(const std::string &path);
+
+	// drop a reference, texture stays resident until evicted
+	extern void release(const std::string &path);
+
+	// texture made at runtime under name, held like an acquired one; takes surface
+	extern cachedTexture *create(const std::string &name, SDL_Surface *surface);
+
+	// replace area of a created texture between frames; takes area sized surface
+	extern void update(cachedTexture *entry, const SDL_Rect &area, SDL_Surface *surface);
+
+	// entry for path without loading it, stable until clear()
+	extern cachedTexture *entry(const std::string &path);
+
+	// texture for a draw this frame, loaded on a miss; nullptr if unloadable
+	extern cachedTexture *get(const std::string &path);
+	extern cachedTexture *get(cachedTexture *entry);
+
+	// resident byte budget, 4 bytes per pixel
+	extern void setBudget(const size_t &bytes);
+
+	// game thread, after each draw list is submitted and only then
+	extern void endFrame();
+
+	// render thread, before taking a draw list; true if any texture changed
+	extern bool sync();
+
+	// free every texture, render thread must be stopped
+	extern void clear();
+
+	struct stats {
+		int hits = 0; // draws of a resident texture
+		int misses = 0; // draws that had to load
+		int loads = 0; // every decode, including acquire
+		int packLoads = 0; // loads served by the asset pack
+		double loadMs = 0; // spent in loads, before upload
+		int evictions = 0;
+		size_t residentBytes = 0;
+		size_t peakBytes = 0;
+	};
+
+	extern stats counters();
+
+	// hit rate, evictions and memory
+	extern void report();
+
+} // end namespace
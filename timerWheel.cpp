@@ -0,0 +1,99 @@
+#include <SDL2/SDL.h>
+#include <vector>
+#include <algorithm>
+
+#include "timerWheel.h"
+
+timerWheel::timerWheel()
+{
+	for (int level = 0; level < LEVELS; level++)
+		for (int slot = 0; slot < SLOTS; slot++)
+			slots[level][slot] = -1;
+}
+
+void timerWheel::add(const Uint32 &due, const int &kind, const Uint32 &target)
+{
+	int entry;
+
+	// reuse a free entry
+	if (freeList >= 0)
+	{
+		entry = freeList;
+		freeList = entries[entry].next;
+	}
+	else
+	{
+		entry = entries.size();
+		entries.push_back(timer());
+	}
+
+	timer &t = entries[entry];
+	t.due = SDL_TICKS_PASSED(current, due) ? current + 1 : due;
+	t.kind = kind;
+	t.target = target;
+
+	insert(entry);
+	count++;
+}
+
+// file entry into the finest level whose range reaches its due tick
+void timerWheel::insert(const int &entry)
+{
+	timer &t = entries[entry];
+	Uint32 delta = t.due - current;
+
+	int level = 0;
+	while (level < LEVELS - 1 && delta >= (Uint32)SLOTS << (level * BITS))
+		level++;
+
+	int slot = (t.due >> (level * BITS)) & (SLOTS - 1);
+	t.next = slots[level][slot];
+	slots[level][slot] = entry;
+}
+
+void timerWheel::advance(const Uint32 &tick, std::vector<timer> &expired)
+{
+	while (SDL_TICKS_PASSED(tick, current + 1))
+	{
+		current++;
+
+		// wrapped a level: move the coarser slot's timers down
+		for (int level = 1; level < LEVELS; level++)
+		{
+			if ((current & ((1u << (level * BITS)) - 1)) != 0)
+				break;
+
+			int slot = (current >> (level * BITS)) & (SLOTS - 1);
+			int entry = slots[level][slot];
+			slots[level][slot] = -1;
+
+			while (entry >= 0)
+			{
+				int next = entries[entry].next;
+				insert(entry);
+				entry = next;
+			}
+		}
+
+		// expire this tick's slot, timers added by the caller during
+		// dispatch land in later slots
+		int slot = current & (SLOTS - 1);
+		int entry = slots[0][slot];
+		slots[0][slot] = -1;
+
+		// list is newest first, expire in insertion order
+		size_t first = expired.size();
+		while (entry >= 0)
+		{
+			int next = entries[entry].next;
+
+			expired.push_back(entries[entry]);
+			entries[entry].next = freeList;
+			freeList = entry;
+			count--;
+
+			entry = next;
+		}
+		std::reverse(expired.begin() + first, expired.end());
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// pending timer, plain data so the wheel can be copied into snapshots
+struct timer {
+	Uint32 due; // tick
+	int kind; // what expired, meaning is up to the caller
+	Uint32 target; // entity slot the timer belongs to
+	int next; // next entry in the same wheel slot, -1 ends the list
+};
+
+// hierarchical timing wheel
+// =========================
+// Four levels of 64 slots, each level 64 times coarser than the one below,
+// covering 2^24 ticks. advance() only touches the slot for the new tick,
+// plus one coarser slot every 64 ticks whose timers cascade down, so the
+// cost per tick follows the number of expirations, not of pending timers.
+// Timers are never cancelled: targets that are gone are skipped by the
+// caller when the timer expires.
+class timerWheel {
+	public:
+
+	timerWheel();
+
+	// expire at tick due, due in the past expires on the next advance
+	void add(const Uint32 &due, const int &kind, const Uint32 &target);
+
+	// step to tick, appending expired timers in expiry order
+	void advance(const Uint32 &tick, std::vector<timer> &expired);
+
+	// last tick advanced to
+	Uint32 now() const { return current; }
+
+	int pending() const { return count; }
+
+	private:
+
+	static const int LEVELS = 4;
+	static const int BITS = 6;
+	static const int SLOTS = 1 << BITS;
+
+	void insert(const int &entry);
+
+	Uint32 current = 0;
+	int count = 0;
+
+	std::vector<timer> entries; // pool, free entries chained through next
+	int freeList = -1;
+	int slots[LEVELS][SLOTS];
+};
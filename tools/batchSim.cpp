@@ -0,0 +1,403 @@
+// headless batch simulator for wave difficulty
+// usage: batch-sim [--runs N] [--threads N] [--bot dodge|path] [--path script]
+//                  [--seed S] [--noise %] [--max-seconds S] [--waves file]
+//
+// plays a waves config many times with a bot player, spread over all
+// cores, and prints per-wave death rate, grazes, kill rate, time to clear and
+// enemy bullet density. Configs are parsed once; every run copies the
+// shared prototypes and waves. Run i uses seed S + i, so results don't
+// depend on the thread count.
+//
+// path scripts are "buttons ticks" pairs played in a loop, buttons are
+// any of u d l r f s (up down left right fire slow) or - for none, e.g.
+// "lf 60 rf 60"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#include "global.h"
+#include "logger.h"
+#include "gameObj.h"
+#include "baseObjects.h"
+#include "enemyWaves.h"
+#include "bulletContainers.h"
+#include "configFromFile.h"
+#include "renderBackend.h"
+#include "gameState.h"
+#include "playerInput.h"
+
+typedef std::chrono::steady_clock benchClock;
+
+// one step of a fixed path
+struct pathStep {
+	playerInput input;
+	int ticks;
+};
+
+// options shared by all workers
+static std::string botName = "dodge";
+static std::vector<pathStep> path;
+static int runs = 1000;
+static Uint32 seed = 1;
+static int noise = 10; // % of ticks the bot repeats its last input
+static Uint32 maxTicks = 600 * 60;
+
+// per-wave totals
+struct waveStats {
+	long reached = 0; // runs that saw the wave start
+	long cleared = 0;
+	long deaths = 0;
+	long grazes = 0;
+	long kills = 0;
+	long enemies = 0;
+	long clearTicks = 0; // summed over cleared runs
+	long ticks = 0; // all ticks spent in wave
+	long bulletTicks = 0; // enemy bullets on screen, summed per tick
+	long peakBullets = 0;
+
+	void add(const waveStats &o)
+	{
+		reached += o.reached;
+		cleared += o.cleared;
+		deaths += o.deaths;
+		grazes += o.grazes;
+		kills += o.kills;
+		enemies += o.enemies;
+		clearTicks += o.clearTicks;
+		ticks += o.ticks;
+		bulletTicks += o.bulletTicks;
+		peakBullets = std::max(peakBullets, o.peakBullets);
+	}
+};
+
+struct worker {
+	SDL_Thread *thread = nullptr;
+	std::vector<waveStats> waves;
+	long runs = 0;
+	long ticks = 0;
+	double cpuSeconds = 0; // thread CPU time spent playing
+};
+
+static std::atomic<int> nextRun(0);
+
+static bool parsePath(const std::string &script)
+{
+	std::istringstream in(script);
+	std::string buttons;
+	int ticks;
+
+	while (in >> buttons >> ticks)
+	{
+		pathStep step = {0, ticks};
+
+		for (char c : buttons)
+		{
+			switch (c)
+			{
+			case 'u': step.input |= INPUT_UP; break;
+			case 'd': step.input |= INPUT_DOWN; break;
+			case 'l': step.input |= INPUT_LEFT; break;
+			case 'r': step.input |= INPUT_RIGHT; break;
+			case 'f': step.input |= INPUT_FIRE; break;
+			case 's': step.input |= INPUT_SLOW; break;
+			case '-': break;
+			default: return false;
+			}
+		}
+
+		if (ticks <= 0) return false;
+		path.push_back(step);
+	}
+
+	return !path.empty() && in.eof();
+}
+
+// move away from the nearest enemy bullet, otherwise line up under the
+// nearest enemy near the bottom of the screen; always fire
+static playerInput dodge(const gameObj &hitbox)
+{
+	const int THREAT_RADIUS = 120;
+	const int HOME_Y = global::SCREEN_HEIGHT - 120;
+
+	int hx = hitbox.rect.x + hitbox.rect.w / 2;
+	int hy = hitbox.rect.y + hitbox.rect.h / 2;
+
+	int threat = gameState::bulletIndex.nearest(hx, hy, THREAT_RADIUS);
+
+	playerInput input = INPUT_FIRE;
+
+	if (threat >= 0)
+	{
+		const SDL_Rect &r = currentEnemyBullets[threat].rect;
+		int bx = r.x + r.w / 2;
+		int by = r.y + r.h / 2;
+
+		input |= bx < hx ? INPUT_RIGHT : INPUT_LEFT;
+		input |= by < hy ? INPUT_DOWN : INPUT_UP;
+		return input;
+	}
+
+	const gameObj *target = nullptr;
+	int nearest = global::SCREEN_WIDTH;
+
+	for (auto &enemy : currentEnemies)
+	{
+		int d = std::abs(enemy.rect.x + enemy.rect.w / 2 - hx);
+		if (d < nearest)
+		{
+			nearest = d;
+			target = &enemy;
+		}
+	}
+
+	if (target && nearest > 8)
+		input |= target->rect.x + target->rect.w / 2 < hx ? INPUT_LEFT : INPUT_RIGHT;
+
+	if (hy < HOME_Y - 10)
+		input |= INPUT_DOWN;
+	else if (hy > HOME_Y + 10)
+		input |= INPUT_UP;
+
+	return input;
+}
+
+// play one run, adding to per-wave stats
+static void play(const int &run, worker &w)
+{
+	std::mt19937 rng(seed + run);
+	std::uniform_int_distribution<int> percent(0, 99);
+
+	gameState::init(1);
+	playerState &player = gameState::players[0];
+
+	// fixed path starts at a random step
+	size_t step = path.empty() ? 0 : rng() % path.size();
+	int stepTicks = 0;
+	playerInput input = 0;
+
+	std::vector<long> waveTicks(enemyWaves.size());
+	int lastWave = -1;
+	int lastDeaths = 0;
+	int lastGrazes = 0;
+	int lastKills = 0;
+
+	while (global::ticks < maxTicks)
+	{
+		int wave = gameState::currentWave();
+
+		if (!gameState::stepWorld())
+			break;
+
+		if (wave < 0)
+			wave = gameState::currentWave();
+
+		// bot input, sometimes a tick late
+		if (botName == "path")
+		{
+			input = path[step].input;
+			if (++stepTicks >= path[step].ticks)
+			{
+				step = (step + 1) % path.size();
+				stepTicks = 0;
+			}
+		}
+		else if (percent(rng) >= noise)
+			input = dodge(player.hitbox);
+
+		gameState::stepPlayers(&input);
+
+		if (wave < 0)
+			continue;
+
+		waveStats &s = w.waves[wave];
+
+		// wave started
+		if (wave != lastWave)
+		{
+			s.reached++;
+			s.enemies += enemyWaves[wave].size();
+			lastWave = wave;
+		}
+
+		s.ticks++;
+		waveTicks[wave]++;
+		s.deaths += gameState::deaths() - lastDeaths;
+		s.grazes += gameState::grazes() - lastGrazes;
+		s.kills += global::kills - lastKills;
+		s.bulletTicks += currentEnemyBullets.size();
+		s.peakBullets = std::max(s.peakBullets, (long)currentEnemyBullets.size());
+
+		lastDeaths = gameState::deaths();
+		lastGrazes = gameState::grazes();
+		lastKills = global::kills;
+	}
+
+	// waves left behind were cleared
+	for (int i = 0; i < gameState::wavesCleared(); i++)
+	{
+		w.waves[i].cleared++;
+		w.waves[i].clearTicks += waveTicks[i];
+	}
+
+	w.runs++;
+	w.ticks += global::ticks;
+}
+
+static double threadCpu()
+{
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int workLoop(void *data)
+{
+	worker &w = *(worker *)data;
+	w.waves.resize(enemyWaves.size());
+
+	double cpuStart = threadCpu();
+
+	int run;
+	while ((run = nextRun.fetch_add(1)) < runs)
+		play(run, w);
+
+	w.cpuSeconds = threadCpu() - cpuStart;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int threads = SDL_GetCPUCount();
+	std::string wavesFile = "config/waves.pre";
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--runs" && hasValue)
+			runs = atoi(argv[++i]);
+		else if (arg == "--threads" && hasValue)
+			threads = std::max(1, atoi(argv[++i]));
+		else if (arg == "--bot" && hasValue)
+			botName = argv[++i];
+		else if (arg == "--path" && hasValue)
+		{
+			if (!parsePath(argv[++i]))
+			{
+				fprintf(stderr, "bad path script \"%s\"\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (arg == "--seed" && hasValue)
+			seed = strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--noise" && hasValue)
+			noise = atoi(argv[++i]);
+		else if (arg == "--max-seconds" && hasValue)
+			maxTicks = atoi(argv[++i]) * global::TICK_RATE;
+		else if (arg == "--waves" && hasValue)
+			wavesFile = argv[++i];
+		else
+		{
+			fprintf(stderr, "unknown option %s\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	if (botName != "dodge" && botName != "path")
+	{
+		fprintf(stderr, "unknown bot \"%s\", use dodge or path\n", botName.c_str());
+		return 1;
+	}
+
+	// sweep along the bottom by default
+	if (botName == "path" && path.empty())
+		parsePath("lf 50 rf 100 lf 50");
+
+	logger::start();
+
+	// configs parsed once, textures are never loaded since nothing draws
+	global::headless = true;
+	global::backend = createBackend("null", nullptr);
+
+	bulletsFromFile("config/bullets.conf");
+	enemiesFromFile("config/enemies.conf");
+	bossesFromFile("config/bosses.conf");
+	wavesFromFile(wavesFile, enemyWaves);
+	gameState::definePlayers();
+
+	if (enemyWaves.empty())
+	{
+		fprintf(stderr, "%s has no waves\n", wavesFile.c_str());
+		return 1;
+	}
+
+	// run
+	// ===
+	auto start = benchClock::now();
+
+	std::vector<worker> workers(threads);
+	for (auto &w : workers)
+		w.thread = SDL_CreateThread(workLoop, "batch", &w);
+
+	std::vector<waveStats> total(enemyWaves.size());
+	long simTicks = 0;
+	double cpuSeconds = 0;
+
+	for (auto &w : workers)
+	{
+		if (w.thread)
+			SDL_WaitThread(w.thread, nullptr);
+		else
+			workLoop(&w); // no threads, run on this one
+
+		for (size_t i = 0; i < total.size(); i++)
+			total[i].add(w.waves[i]);
+		simTicks += w.ticks;
+		cpuSeconds += w.cpuSeconds;
+	}
+
+	double seconds = std::chrono::duration<double>(benchClock::now() - start).count();
+
+	// report
+	// ======
+	// scaling is linear while cores busy tracks threads and ticks per CPU
+	// second stays at its one thread value
+	printf("%d runs, bot %s, %d threads: %.2f s, %.0f runs/s, %.0f ticks/s\n",
+		runs, botName.c_str(), threads, seconds, runs / seconds, simTicks / seconds);
+	printf("%.2f cores busy, %.0f ticks per CPU second\n\n",
+		cpuSeconds / seconds, cpuSeconds > 0 ? simTicks / cpuSeconds : 0.0);
+
+	printf("wave  reached  cleared  deaths/run  grazes/run  kill%%  clear s  bullets avg  peak\n");
+	for (size_t i = 0; i < total.size(); i++)
+	{
+		const waveStats &s = total[i];
+		if (s.reached == 0)
+		{
+			printf("%4zu  %7d\n", i + 1, 0);
+			continue;
+		}
+
+		printf("%4zu  %7ld  %7ld  %10.2f  %10.2f  %5.1f  %7.2f  %11.1f  %4ld\n", i + 1, s.reached, s.cleared,
+			(double)s.deaths / s.reached,
+			(double)s.grazes / s.reached,
+			s.enemies ? 100.0 * s.kills / s.enemies : 0.0,
+			s.cleared ? (double)s.clearTicks / s.cleared / global::TICK_RATE : 0.0,
+			s.ticks ? (double)s.bulletTicks / s.ticks : 0.0,
+			s.peakBullets);
+	}
+
+	global::close();
+	logger::stop();
+	return 0;
+}
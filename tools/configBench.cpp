@@ -0,0 +1,134 @@
+// config parser throughput benchmark
+// usage: config-bench [enemies] [dir]
+//
+// generates a waves config with the given number of enemies (default
+// 100000) split over an #include, then times the old getline/stringstream
+// tokenizer, configParser tokenizing alone, and a full wavesFromFile load
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "baseObjects.h"
+#include "configParser.h"
+#include "configFromFile.h"
+#include "gameObj.h"
+#include "logger.h"
+
+typedef std::chrono::steady_clock benchClock;
+
+static double secondsSince(const benchClock::time_point &start)
+{
+	return std::chrono::duration<double>(benchClock::now() - start).count();
+}
+
+static long fileSize(const std::string &fileName)
+{
+	std::ifstream in(fileName, std::ios::binary | std::ios::ate);
+	return in ? (long)in.tellg() : 0;
+}
+
+// write waves.pre including waves.inc with numEnemies enemies, 10 per wave
+static void generate(const std::string &dir, const int &numEnemies)
+{
+	std::ofstream pre(dir + "/waves.pre");
+	pre << "#define SHORT 200\n#define LONG 400\n#include waves.inc\n";
+
+	std::ofstream inc(dir + "/waves.inc");
+	for (int i = 0; i < numEnemies; i++)
+	{
+		inc << "bat " << (i * 37) % 750 << " " << (i * 11) % 100 << "\n";
+		inc << "SHORT down right fire\n";
+		inc << "LONG left fire\n";
+		inc << "0 down fire\n";
+		inc << "ENDE\n";
+
+		if (i % 10 == 9)
+			inc << "ENDW\n# next wave\n";
+	}
+	inc << "ENDW\n";
+}
+
+// tokenizer the loaders used before configParser
+static long legacyTokenize(const std::string &fileName)
+{
+	std::ifstream infile(fileName);
+	std::string line;
+	std::string tok;
+	std::vector<std::string> args;
+	long tokens = 0;
+
+	while (std::getline(infile, line))
+	{
+		if (line.length() > 0 && line[0] != '#')
+		{
+			std::stringstream ss(line);
+			while (std::getline(ss, tok, ' '))
+				args.push_back(tok);
+
+			tokens += args.size();
+			args.clear();
+		}
+	}
+
+	return tokens;
+}
+
+static long parserTokenize(const std::string &fileName, long &lines)
+{
+	configParser parser(fileName);
+	std::vector<token> args;
+	long tokens = 0;
+	lines = 0;
+
+	while (parser.nextLine(args))
+	{
+		tokens += args.size();
+		lines++;
+	}
+
+	return tokens;
+}
+
+int main(int argc, char *argv[])
+{
+	int numEnemies = argc > 1 ? atoi(argv[1]) : 100000;
+	std::string dir = argc > 2 ? argv[2] : "/tmp";
+
+	logger::start();
+
+	generate(dir, numEnemies);
+	std::string pre = dir + "/waves.pre";
+	std::string inc = dir + "/waves.inc";
+	double megabytes = (fileSize(pre) + fileSize(inc)) / 1e6;
+
+	// prototypes, textures are never loaded
+	int orange = prototypes::define(archetype("orange", "assets/bullet-orange.png", 10, 20, 20));
+	prototypes::define(archetype("bat", "assets/enemy-bat.png", 6, 50, 46, orange, 200));
+
+	printf("%d enemies, %.1f MB\n", numEnemies, megabytes);
+
+	auto start = benchClock::now();
+	long legacyTokens = legacyTokenize(inc);
+	double legacy = secondsSince(start);
+	printf("getline/stringstream:  %7.1f ms  %7.1f MB/s  (%ld tokens, no macros)\n", legacy * 1e3, megabytes / legacy, legacyTokens);
+
+	long lines;
+	start = benchClock::now();
+	long tokens = parserTokenize(pre, lines);
+	double tokenize = secondsSince(start);
+	printf("configParser:          %7.1f ms  %7.1f MB/s  (%ld tokens, %ld lines)\n", tokenize * 1e3, megabytes / tokenize, tokens, lines);
+
+	std::vector<std::vector<gameObj>> waves;
+	start = benchClock::now();
+	wavesFromFile(pre, waves);
+	double load = secondsSince(start);
+	printf("wavesFromFile:         %7.1f ms  %7.1f MB/s  (%zu waves)\n", load * 1e3, megabytes / load, waves.size());
+
+	logger::stop();
+	return 0;
+}
@@ -0,0 +1,190 @@
+// enemy bullet spatial index benchmark
+// usage: index-bench [bullets] [ticks]
+//
+// keeps the given number of bullets (default 10000) falling at mixed
+// speeds for a number of ticks (default 600), respawning them at the top.
+// Times the incremental spatialIndex refresh against clearing and refilling
+// the index, then a graze query and a nearest bullet query against scanning
+// every bullet, and checks both give the same answers
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "gameObj.h"
+#include "global.h"
+#include "logger.h"
+#include "spatialIndex.h"
+
+typedef std::chrono::steady_clock benchClock;
+
+static const int GRAZE_RADIUS = 24;
+static const int THREAT_RADIUS = 120;
+static const int CELL = 32;
+
+// bullets and their speeds, kept sorted by id like currentEnemyBullets
+struct field {
+	std::vector<gameObj> bullets;
+	std::vector<int> speeds;
+	Uint32 nextId = 1;
+	std::mt19937 rng;
+
+	void spawn(const int &y)
+	{
+		gameObj b;
+		b.rect = global::makeRect(rng() % global::SCREEN_WIDTH, y, 16, 16);
+		b.id = nextId++;
+		bullets.push_back(b);
+		speeds.push_back(2 + rng() % 8);
+	}
+
+	// move, drop offscreen bullets in place and top up from above
+	void step()
+	{
+		size_t kept = 0;
+		for (size_t i = 0; i < bullets.size(); i++)
+		{
+			bullets[i].rect.y += speeds[i];
+			if (bullets[i].rect.y >= global::SCREEN_HEIGHT) continue;
+
+			bullets[kept] = bullets[i];
+			speeds[kept] = speeds[i];
+			kept++;
+		}
+
+		int lost = bullets.size() - kept;
+		bullets.resize(kept);
+		speeds.resize(kept);
+
+		for (int i = 0; i < lost; i++)
+			spawn(-16);
+	}
+};
+
+// bullets within GRAZE_RADIUS of the hitbox, like spatialIndex::within
+static void scanWithin(const std::vector<gameObj> &bullets, const SDL_Rect &hitbox, std::vector<int> &out)
+{
+	out.clear();
+	for (size_t i = 0; i < bullets.size(); i++)
+	{
+		const SDL_Rect &b = bullets[i].rect;
+
+		int dx = std::max(0, std::max(hitbox.x - (b.x + b.w), b.x - (hitbox.x + hitbox.w)));
+		int dy = std::max(0, std::max(hitbox.y - (b.y + b.h), b.y - (hitbox.y + hitbox.h)));
+		if (dx * dx + dy * dy <= GRAZE_RADIUS * GRAZE_RADIUS)
+			out.push_back(i);
+	}
+}
+
+// nearest centre closer than THREAT_RADIUS, like spatialIndex::nearest
+static int scanNearest(const std::vector<gameObj> &bullets, const int &x, const int &y)
+{
+	int nearest = -1;
+	int best = THREAT_RADIUS * THREAT_RADIUS;
+
+	for (size_t i = 0; i < bullets.size(); i++)
+	{
+		const SDL_Rect &b = bullets[i].rect;
+		int dx = b.x + b.w / 2 - x;
+		int dy = b.y + b.h / 2 - y;
+
+		if (dx * dx + dy * dy < best)
+		{
+			best = dx * dx + dy * dy;
+			nearest = i;
+		}
+	}
+
+	return nearest;
+}
+
+static double secondsSince(const benchClock::time_point &start)
+{
+	return std::chrono::duration<double>(benchClock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	int numBullets = argc > 1 ? atoi(argv[1]) : 10000;
+	int ticks = argc > 2 ? atoi(argv[2]) : 600;
+
+	logger::start();
+
+	field f;
+	f.rng.seed(1);
+	for (int i = 0; i < numBullets; i++)
+		f.spawn(f.rng() % global::SCREEN_HEIGHT);
+
+	// bullets spread over the screen before timing
+	for (int t = 0; t < 60; t++)
+		f.step();
+
+	// hitbox sweeps across the lower screen
+	SDL_Rect hitbox = global::makeRect(0, global::SCREEN_HEIGHT - 120, 10, 10);
+
+	spatialIndex incremental(global::SCREEN_WIDTH, global::SCREEN_HEIGHT, CELL);
+	spatialIndex rebuilt(global::SCREEN_WIDTH, global::SCREEN_HEIGHT, CELL);
+	std::vector<int> grazes, expected;
+
+	double refreshTime = 0, rebuildTime = 0;
+	double withinTime = 0, scanWithinTime = 0;
+	double nearestTime = 0, scanNearestTime = 0;
+	long found = 0;
+	int mismatches = 0;
+
+	for (int t = 0; t < ticks; t++)
+	{
+		f.step();
+		hitbox.x = (t * 7) % (global::SCREEN_WIDTH - hitbox.w);
+		int hx = hitbox.x + hitbox.w / 2;
+		int hy = hitbox.y + hitbox.h / 2;
+
+		auto start = benchClock::now();
+		incremental.refresh(f.bullets);
+		refreshTime += secondsSince(start);
+
+		start = benchClock::now();
+		rebuilt.clear();
+		rebuilt.refresh(f.bullets);
+		rebuildTime += secondsSince(start);
+
+		start = benchClock::now();
+		incremental.within(hitbox, GRAZE_RADIUS, grazes);
+		withinTime += secondsSince(start);
+
+		start = benchClock::now();
+		scanWithin(f.bullets, hitbox, expected);
+		scanWithinTime += secondsSince(start);
+
+		start = benchClock::now();
+		int nearest = incremental.nearest(hx, hy, THREAT_RADIUS);
+		nearestTime += secondsSince(start);
+
+		start = benchClock::now();
+		int scanned = scanNearest(f.bullets, hx, hy);
+		scanNearestTime += secondsSince(start);
+
+		if (grazes != expected || nearest != scanned)
+			mismatches++;
+		found += grazes.size();
+	}
+
+	spatialIndex::stats s = incremental.counters();
+	double us = 1e6 / ticks;
+
+	printf("%d bullets, %d ticks, %d px cells, us per tick\n", numBullets, ticks, CELL);
+	printf("refresh:        %7.1f  (%.0f moved, %.0f added, %.0f removed per tick)\n",
+		refreshTime * us, (double)s.moved / s.refreshes, (double)s.added / s.refreshes, (double)s.removed / s.refreshes);
+	printf("clear + refill: %7.1f\n", rebuildTime * us);
+	printf("graze query:    %7.1f  index, %7.1f  scan\n", withinTime * us, scanWithinTime * us);
+	printf("nearest query:  %7.1f  index, %7.1f  scan  (%.0f candidates per index query)\n",
+		nearestTime * us, scanNearestTime * us, (double)s.candidates / s.queries);
+	printf("%.1f grazing bullets per tick, %d ticks disagree with the scan\n", (double)found / ticks, mismatches);
+
+	logger::stop();
+	return mismatches == 0 ? 0 : 1;
+}
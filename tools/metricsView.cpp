@@ -0,0 +1,191 @@
+// live viewer for the shared memory metrics written with --metrics
+// usage: metrics-view <name> [--interval ms] [--once]
+//
+// maps the game's metrics block read only and redraws every interval
+// (default 250 ms): counters, entity counts, work per tick and frame time
+// percentiles, with charts of the last samples of p99 frame time and
+// enemy bullets. --once prints one sample and exits. Reads never block the
+// game; a copy torn by a concurrent write is simply read again.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "liveMetricsFormat.h"
+
+using namespace liveMetrics;
+
+// chart size in samples and rows
+static const int HISTORY = 60;
+static const int CHART_ROWS = 8;
+
+static const char *stateNames[] = { "running", "paused", "waiting for peer", "ended" };
+
+// consistent copy of the block, false if the writer kept it busy
+static bool readBlock(const metricsBlock *shared, metricsBlock &copy)
+{
+	for (int attempt = 0; attempt < 1000; attempt++)
+	{
+		std::uint32_t before = shared->sequence.load(std::memory_order_acquire);
+		if (before & 1)
+			continue;
+
+		memcpy((void *)&copy, (const void *)shared, sizeof(copy));
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (shared->sequence.load(std::memory_order_relaxed) == before)
+			return true;
+	}
+
+	return false;
+}
+
+// bar chart of values, oldest on the left, scaled to the largest
+static void printChart(const char *title, const std::vector<double> &values, const char *unit)
+{
+	double peak = 0;
+	for (auto v : values)
+		peak = std::max(peak, v);
+
+	printf("\n%s, peak %.1f %s\n", title, peak, unit);
+	if (peak <= 0)
+		return;
+
+	std::string line;
+	for (int row = CHART_ROWS; row > 0; row--)
+	{
+		line.assign(1, '|');
+		for (auto v : values)
+			line += v * CHART_ROWS / peak >= row - 0.5 ? '#' : ' ';
+		printf("  %s\n", line.c_str());
+	}
+	printf("  +%s\n", std::string(values.size(), '-').c_str());
+}
+
+static void print(const metricsBlock &m)
+{
+	printf("pid %u  %s  tick %u  wave %d of %d\n", m.pid, stateNames[std::min(m.state, (std::uint32_t)STATE_ENDED)],
+		m.tick, m.wave < 0 ? 0 : m.wave + 1, m.waves);
+	printf("kills %d  deaths %d  grazes %d  shots %d  distance %d\n",
+		m.kills, m.deaths, m.grazes, m.shotsFired, m.distanceTraveled);
+	printf("enemies %u  bosses %u  player bullets %u  enemy bullets %u  particles %u\n",
+		m.enemies, m.bosses, m.playerBullets, m.enemyBullets, m.particles);
+	printf("collision tests %u last tick, %llu total\n", m.collisionTestsLast, (unsigned long long)m.collisionTests);
+	if (m.flags & FLAG_ALLOCATIONS)
+		printf("allocations %u last tick, %llu total\n", m.allocationsLast, (unsigned long long)m.allocations);
+	else
+		printf("allocations not counted, build with make COUNT_ALLOCATIONS=1\n");
+	printf("frame ms  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f   work ms  p50 %.2f  p99 %.2f\n",
+		m.frameP50 / 1000.0, m.frameP90 / 1000.0, m.frameP99 / 1000.0, m.frameMax / 1000.0,
+		m.workP50 / 1000.0, m.workP99 / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+	std::string name;
+	int intervalMs = 250;
+	bool once = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--interval" && i + 1 < argc)
+			intervalMs = std::max(10, atoi(argv[++i]));
+		else if (arg == "--once")
+			once = true;
+		else if (name.empty())
+			name = arg;
+		else
+		{
+			fprintf(stderr, "unknown option %s\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	if (name.empty())
+	{
+		fprintf(stderr, "usage: metrics-view <name> [--interval ms] [--once]\n");
+		return 1;
+	}
+	if (name[0] != '/')
+		name = "/" + name;
+
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+	{
+		fprintf(stderr, "no metrics at %s, is the game running with --metrics %s?\n", name.c_str(), name.c_str());
+		return 1;
+	}
+
+	void *data = mmap(nullptr, sizeof(metricsBlock), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		perror("mmap");
+		return 1;
+	}
+
+	const metricsBlock *shared = (const metricsBlock *)data;
+	if (memcmp(shared->magic, MAGIC, sizeof(MAGIC)) != 0 || shared->version != VERSION || shared->size != sizeof(metricsBlock))
+	{
+		fprintf(stderr, "%s is not a version %d metrics block\n", name.c_str(), VERSION);
+		return 1;
+	}
+
+	std::vector<double> frameHistory;
+	std::vector<double> bulletHistory;
+	std::uint32_t lastUpdates = 0;
+	int quietSamples = 0;
+
+	while (true)
+	{
+		metricsBlock m;
+		if (!readBlock(shared, m))
+		{
+			fprintf(stderr, "metrics block busy, retrying\n");
+			usleep(intervalMs * 1000);
+			continue;
+		}
+
+		// a game that stops publishing without ending has hung or crashed
+		quietSamples = m.updates == lastUpdates ? quietSamples + 1 : 0;
+		lastUpdates = m.updates;
+
+		if (once)
+		{
+			print(m);
+			break;
+		}
+
+		frameHistory.push_back(m.frameP99 / 1000.0);
+		bulletHistory.push_back(m.enemyBullets);
+		if ((int)frameHistory.size() > HISTORY)
+		{
+			frameHistory.erase(frameHistory.begin());
+			bulletHistory.erase(bulletHistory.begin());
+		}
+
+		printf("\033[H\033[2J%s\n\n", name.c_str());
+		print(m);
+		if (quietSamples * intervalMs >= 1000)
+			printf("\nno updates for %d ms\n", quietSamples * intervalMs);
+		printChart("p99 frame time", frameHistory, "ms");
+		printChart("enemy bullets", bulletHistory, "");
+		fflush(stdout);
+
+		if (m.state == STATE_ENDED)
+			break;
+
+		usleep(intervalMs * 1000);
+	}
+
+	munmap(data, sizeof(metricsBlock));
+	return 0;
+}
@@ -0,0 +1,246 @@
+// asset pack builder
+// usage: pack-assets [--out file] [--lz4] [--runs N] [image...]
+//
+// loads the configs like the game, decodes every image an archetype uses
+// plus any named on the command line (the background is defined in code)
+// to ARGB8888 and writes them to one archive, assets/assets.pack by
+// default. --lz4 compresses images where that saves space.
+//
+// Then times getting every image ready for upload both ways, N times each
+// (default 5): decoding the PNGs as the game does without a pack, and
+// mapping the pack and reading it. Cold runs ask the kernel to drop the
+// files from the page cache first (posix_fadvise, best effort; drop_caches
+// needs root), warm runs don't. Both paths must give the same pixels.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "global.h"
+#include "logger.h"
+#include "baseObjects.h"
+#include "configFromFile.h"
+#include "renderBackend.h"
+#include "gameState.h"
+#include "textureCache.h"
+#include "assetPack.h"
+
+typedef std::chrono::steady_clock benchClock;
+
+static double msSince(const benchClock::time_point &start)
+{
+	return std::chrono::duration<double, std::milli>(benchClock::now() - start).count();
+}
+
+// ask the kernel to forget a file's cached pages
+static void dropCache(const std::string &path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+}
+
+static long fileSize(const std::string &path)
+{
+	struct stat st;
+	return stat(path.c_str(), &st) < 0 ? 0 : st.st_size;
+}
+
+// decode to ARGB8888 rows with no padding, what the pack stores
+static bool decode(const std::string &path, assetPack::image &img)
+{
+	SDL_Surface *loaded = IMG_Load(path.c_str());
+	if (loaded == nullptr)
+		return false;
+
+	SDL_Surface *argb = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(loaded);
+	if (argb == nullptr)
+		return false;
+
+	img.path = path;
+	img.width = argb->w;
+	img.height = argb->h;
+	img.pixels.resize(argb->w * argb->h);
+
+	for (int y = 0; y < argb->h; y++)
+		memcpy(&img.pixels[y * argb->w], (Uint8 *)argb->pixels + y * argb->pitch, argb->w * 4);
+
+	SDL_FreeSurface(argb);
+	return true;
+}
+
+// reads every pixel like an upload would, sum doubles as a check
+static Uint64 checksum(const SDL_Surface *s)
+{
+	Uint64 sum = 0;
+	for (int y = 0; y < s->h; y++)
+	{
+		const Uint32 *row = (const Uint32 *)((const Uint8 *)s->pixels + y * s->pitch);
+		for (int x = 0; x < s->w; x++)
+			sum = sum * 31 + row[x];
+	}
+	return sum;
+}
+
+// every image as the game loads it without a pack, converted for upload
+static Uint64 loadPngs(const std::vector<std::string> &paths)
+{
+	Uint64 sum = 0;
+	for (auto &path : paths)
+	{
+		SDL_Surface *loaded = IMG_Load(path.c_str());
+		SDL_Surface *argb = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+		if (argb)
+			sum += checksum(argb);
+		SDL_FreeSurface(loaded);
+		SDL_FreeSurface(argb);
+	}
+	return sum;
+}
+
+static Uint64 loadPack(const std::string &packFile, const std::vector<std::string> &paths)
+{
+	Uint64 sum = 0;
+	assetPack::open(packFile);
+	for (auto &path : paths)
+	{
+		SDL_Surface *s = assetPack::load(path);
+		if (s)
+			sum += checksum(s);
+		SDL_FreeSurface(s);
+	}
+	assetPack::close();
+	return sum;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string packFile = "assets/assets.pack";
+	bool compress = false;
+	int runs = 5;
+	std::vector<std::string> extra;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--out" && hasValue)
+			packFile = argv[++i];
+		else if (arg == "--lz4")
+			compress = true;
+		else if (arg == "--runs" && hasValue)
+			runs = std::max(1, atoi(argv[++i]));
+		else if (arg.compare(0, 2, "--") == 0)
+		{
+			fprintf(stderr, "unknown option %s\n", arg.c_str());
+			return 1;
+		}
+		else
+			extra.push_back(arg);
+	}
+
+	logger::start();
+
+	// archetypes only name their images, nothing is loaded
+	global::headless = true;
+	global::backend = createBackend("null", nullptr);
+
+	bulletsFromFile("config/bullets.conf");
+	enemiesFromFile("config/enemies.conf");
+	bossesFromFile("config/bosses.conf");
+	gameState::definePlayers();
+
+	std::set<std::string> unique(extra.begin(), extra.end());
+	for (auto &a : prototypes::all)
+		if (a.texture)
+			unique.insert(a.texture->path);
+	std::vector<std::string> paths(unique.begin(), unique.end());
+
+	if (!IMG_Init(IMG_INIT_PNG))
+	{
+		fprintf(stderr, "SDL_image could not initialize: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	// pack
+	// ====
+	std::vector<assetPack::image> images(paths.size());
+	long pngBytes = 0;
+	long pixelBytes = 0;
+
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		if (!decode(paths[i], images[i]))
+		{
+			fprintf(stderr, "could not load %s: %s\n", paths[i].c_str(), SDL_GetError());
+			return 1;
+		}
+		pngBytes += fileSize(paths[i]);
+		pixelBytes += images[i].pixels.size() * 4;
+	}
+
+	if (!assetPack::write(packFile, images, compress))
+		return 1;
+
+	printf("%s: %zu images, %ld KB of pixels, %ld KB packed%s, %ld KB of PNG\n", packFile.c_str(), images.size(),
+		pixelBytes / 1024, fileSize(packFile) / 1024, compress ? " with lz4" : "", pngBytes / 1024);
+
+	// time
+	// ====
+	// both paths read every pixel, the pack's uncompressed images are only
+	// paged in when touched
+	double pngCold = 0, pngWarm = 0, packCold = 0, packWarm = 0;
+	Uint64 pngSum = 0, packSum = 0;
+
+	for (int r = 0; r < runs; r++)
+	{
+		for (auto &path : paths)
+			dropCache(path);
+		auto start = benchClock::now();
+		pngSum = loadPngs(paths);
+		pngCold += msSince(start);
+
+		start = benchClock::now();
+		loadPngs(paths);
+		pngWarm += msSince(start);
+
+		dropCache(packFile);
+		start = benchClock::now();
+		packSum = loadPack(packFile, paths);
+		packCold += msSince(start);
+
+		start = benchClock::now();
+		loadPack(packFile, paths);
+		packWarm += msSince(start);
+	}
+
+	printf("\n%-6s %10s %10s\n", "", "cold ms", "warm ms");
+	printf("%-6s %10.2f %10.2f\n", "png", pngCold / runs, pngWarm / runs);
+	printf("%-6s %10.2f %10.2f\n", "pack", packCold / runs, packWarm / runs);
+	printf("\npack is %.1fx faster cold, %.1fx warm\n", pngCold / packCold, pngWarm / packWarm);
+
+	if (pngSum != packSum)
+	{
+		fprintf(stderr, "pack pixels differ from the PNGs\n");
+		return 1;
+	}
+
+	IMG_Quit();
+	return 0;
+}
@@ -0,0 +1,229 @@
+// offline analyzer for telemetry logs written with --telemetry
+// usage: telemetry-stats <log> [--no-heatmap] [--pgm prefix]
+//
+// single pass over the memory mapped log, prints per-wave stats and
+// enemy bullet density heatmaps (optionally as PGM images)
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "telemetryFormat.h"
+
+using namespace telemetry;
+
+// heatmap cell size in pixels
+static const int CELL = 20;
+
+struct waveStats {
+	bool seen = false;
+	std::uint32_t startTick = 0;
+	std::uint32_t endTick = 0;
+	bool ended = false;
+	int spawns = 0;
+	int kills = 0;
+	int parts = 0; // boss parts destroyed, not kills
+	int deaths = 0;
+	int playerShots = 0;
+	int enemyShots = 0;
+	long samples = 0;
+	bool sampled = false;
+	std::uint32_t lastSampleTick = 0;
+	int peakBullets = 0;
+	int currentBullets = 0;
+	std::vector<std::uint32_t> heat;
+};
+
+static void printHeatmap(const waveStats &w, const int &cols, const int &rows)
+{
+	static const char ramp[] = " .:-=+*#%@";
+	std::uint32_t peak = 0;
+	for (auto c : w.heat)
+		if (c > peak) peak = c;
+
+	if (peak == 0) return;
+
+	std::string line;
+	for (int y = 0; y < rows; y++)
+	{
+		line.assign(1, '|');
+		for (int x = 0; x < cols; x++)
+			line += ramp[(std::uint64_t)w.heat[y * cols + x] * 9 / peak];
+		line += '|';
+		printf("  %s\n", line.c_str());
+	}
+}
+
+static void writePgm(const std::string &fileName, const waveStats &w, const int &cols, const int &rows)
+{
+	std::uint32_t peak = 1;
+	for (auto c : w.heat)
+		if (c > peak) peak = c;
+
+	FILE *out = fopen(fileName.c_str(), "wb");
+	if (out == nullptr)
+	{
+		fprintf(stderr, "could not write %s\n", fileName.c_str());
+		return;
+	}
+
+	fprintf(out, "P5\n%d %d\n255\n", cols, rows);
+	for (auto c : w.heat)
+		fputc((int)((std::uint64_t)c * 255 / peak), out);
+
+	fclose(out);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <log> [--no-heatmap] [--pgm prefix]\n", argv[0]);
+		return 1;
+	}
+
+	bool heatmap = true;
+	std::string pgmPrefix;
+	for (int i = 2; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--no-heatmap"))
+			heatmap = false;
+		else if (!strcmp(argv[i], "--pgm") && i + 1 < argc)
+			pgmPrefix = argv[++i];
+	}
+
+	// map log
+	int fd = open(argv[1], O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(telemetryHeader))
+	{
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		return 1;
+	}
+
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		fprintf(stderr, "could not map %s\n", argv[1]);
+		return 1;
+	}
+	madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+	telemetryHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) || header.version != VERSION || header.eventSize != sizeof(telemetryEvent))
+	{
+		fprintf(stderr, "%s is not a version %d telemetry log\n", argv[1], VERSION);
+		return 1;
+	}
+
+	const telemetryEvent *events = (const telemetryEvent *)((const char *)data + sizeof(header));
+	size_t numEvents = (st.st_size - sizeof(header)) / sizeof(telemetryEvent);
+
+	int cols = (header.screenWidth + CELL - 1) / CELL;
+	int rows = (header.screenHeight + CELL - 1) / CELL;
+
+	// single pass over events
+	std::vector<waveStats> waves;
+	std::uint32_t lastTick = 0;
+
+	for (size_t i = 0; i < numEvents; i++)
+	{
+		const telemetryEvent &e = events[i];
+		if (e.wave >= waves.size())
+			waves.resize(e.wave + 1);
+		waveStats &w = waves[e.wave];
+		lastTick = e.tick;
+
+		switch (e.type)
+		{
+		case EVENT_WAVE_START:
+			w.seen = true;
+			w.startTick = e.tick;
+			break;
+		case EVENT_WAVE_END:
+			w.ended = true;
+			w.endTick = e.tick;
+			break;
+		case EVENT_SPAWN:
+			w.spawns++;
+			break;
+		case EVENT_HIT:
+			w.kills++;
+			break;
+		case EVENT_PART_DESTROYED:
+			w.parts++;
+			break;
+		case EVENT_DEATH:
+			w.deaths++;
+			break;
+		case EVENT_FIRE:
+			if (e.arg == 0) w.playerShots++;
+			else w.enemyShots++;
+			break;
+		case EVENT_BULLET:
+		{
+			if (!w.sampled || e.tick != w.lastSampleTick)
+			{
+				w.sampled = true;
+				w.lastSampleTick = e.tick;
+				w.currentBullets = 0;
+			}
+			if (++w.currentBullets > w.peakBullets)
+				w.peakBullets = w.currentBullets;
+			w.samples++;
+
+			int cx = e.x / CELL;
+			int cy = e.y / CELL;
+			if (cx >= 0 && cx < cols && cy >= 0 && cy < rows)
+			{
+				if (w.heat.empty())
+					w.heat.assign(cols * rows, 0);
+				w.heat[cy * cols + cx]++;
+			}
+			break;
+		}
+		}
+	}
+
+	printf("%zu events, %u ticks\n", numEvents, lastTick);
+
+	for (size_t i = 0; i < waves.size(); i++)
+	{
+		waveStats &w = waves[i];
+		if (!w.seen) continue;
+
+		std::uint32_t end = w.ended ? w.endTick : lastTick;
+		double seconds = (end - w.startTick) / 60.0;
+
+		// sample ticks with no bullets write no events but count toward the average
+		std::uint32_t sampleTicks = header.sampleInterval ? (end - w.startTick) / header.sampleInterval : 0;
+		if (sampleTicks == 0) sampleTicks = 1;
+
+		printf("\nwave %zu%s\n", i + 1, w.ended ? "" : " (not cleared)");
+		printf("  time:          %.1fs (%u ticks)\n", seconds, end - w.startTick);
+		printf("  kills:         %d/%d\n", w.kills, w.spawns);
+		if (w.parts > 0)
+			printf("  boss parts:    %d destroyed\n", w.parts);
+		printf("  deaths:        %d\n", w.deaths);
+		printf("  shots:         %d player, %d enemy\n", w.playerShots, w.enemyShots);
+		printf("  bullets:       %.1f avg, %d peak on screen\n", (double)w.samples / sampleTicks, w.peakBullets);
+
+		if (w.heat.empty()) continue;
+
+		if (heatmap)
+			printHeatmap(w, cols, rows);
+
+		if (pgmPrefix != "")
+			writePgm(pgmPrefix + "wave" + std::to_string(i + 1) + ".pgm", w, cols, rows);
+	}
+
+	munmap(data, st.st_size);
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+// lock-free single producer, single consumer triple buffer
+// producer fills writeBuffer() then publish()es it, consumer acquire()s
+// the newest published buffer; neither side ever waits on the other
+template <typename T>
+class tripleBuffer {
+	public:
+
+	tripleBuffer() : middle(1) {}
+
+	// producer side
+	T &writeBuffer() { return buffers[back]; }
+
+	void publish()
+	{
+		back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// consumer side
+	// returns false if nothing new was published since last acquire
+	bool acquire()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	T &readBuffer() { return buffers[front]; }
+
+	private:
+
+	static const int INDEX = 3;
+	static const int FRESH = 4;
+
+	T buffers[3];
+	std::atomic<int> middle; // index of shared buffer, FRESH bit if unread
+	int back = 0; // owned by producer
+	int front = 2; // owned by consumer
+};